@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace utils_tm
+{
+namespace allocators_tm
+{
+
+// Pool for fixed size nodes.  Every thread keeps a free list of nodes, when
+// it runs empty it is refilled from a shared free list, or by carving a new
+// slab of SlabSize nodes.  Freed nodes go to the free list of the freeing
+// thread (if it grows too large, one slab worth of nodes is spilled into the
+// shared free list).  Thus, allocate/deallocate usually touch only thread
+// local memory.
+//
+// Nodes can be freed by any thread (also after the allocating thread has
+// terminated), therefore, slabs are never returned to the system.
+template <size_t Size, size_t Align, size_t SlabSize>
+class node_pool
+{
+  private:
+    struct free_node
+    {
+        free_node* next;
+    };
+
+    static constexpr size_t node_align = std::max(Align, alignof(free_node));
+    static constexpr size_t node_size =
+        (std::max(Size, sizeof(free_node)) + node_align - 1) / node_align *
+        node_align;
+    static constexpr size_t max_local = 2 * SlabSize;
+
+    struct global_pool
+    {
+        std::mutex         mutex;
+        free_node*         free = nullptr;
+        std::vector<void*> slabs;
+    };
+
+    struct local_pool
+    {
+        free_node* free   = nullptr;
+        size_t     size   = 0;
+        bool       exited = false;
+    };
+
+    // returns the thread's nodes to the shared free list on thread exit
+    struct local_flush
+    {
+        ~local_flush()
+        {
+            auto& l = local_state();
+            if (l.free) push_global(l.free, l.size);
+            l.free   = nullptr;
+            l.size   = 0;
+            l.exited = true;
+        }
+    };
+
+    // never destroyed, nodes may be freed during static destruction
+    static global_pool& global()
+    {
+        static global_pool* g = new global_pool();
+        return *g;
+    }
+    static local_pool& local_state()
+    {
+        static thread_local local_pool l;
+        return l;
+    }
+    static local_pool& local()
+    {
+        // registers the exit handler of this thread
+        static thread_local local_flush flush;
+        (void)flush;
+        return local_state();
+    }
+
+    static inline void push_global(free_node* first, size_t n);
+    static inline void refill(local_pool& l);
+
+  public:
+    static constexpr size_t slab_size = SlabSize;
+
+    static inline void* allocate();
+    static inline void  deallocate(void* ptr);
+};
+
+template <class T, size_t SlabSize = 64>
+class node_pool_allocator
+{
+  public:
+    using value_type                             = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal                        = std::true_type;
+
+    template <class U>
+    struct rebind
+    {
+        using other = node_pool_allocator<U, SlabSize>;
+    };
+
+    node_pool_allocator() noexcept                           = default;
+    node_pool_allocator(const node_pool_allocator&) noexcept = default;
+    ~node_pool_allocator()                                   = default;
+
+    template <class U>
+    node_pool_allocator(const node_pool_allocator<U, SlabSize>&) noexcept
+    {
+    }
+
+    // only single nodes are pooled (T may be incomplete until allocate)
+    T* allocate(std::size_t n)
+    {
+        using pool_type = node_pool<sizeof(T), alignof(T), SlabSize>;
+        if (n == 1) return static_cast<T*>(pool_type::allocate());
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        using pool_type = node_pool<sizeof(T), alignof(T), SlabSize>;
+        if (n == 1) return pool_type::deallocate(p);
+        ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+};
+
+template <class T, class U, size_t Ts, size_t Us>
+bool operator==(const node_pool_allocator<T, Ts>&,
+                const node_pool_allocator<U, Us>&) noexcept
+{
+    return Ts == Us;
+}
+
+template <class T, class U, size_t Ts, size_t Us>
+bool operator!=(const node_pool_allocator<T, Ts>&,
+                const node_pool_allocator<U, Us>&) noexcept
+{
+    return Ts != Us;
+}
+
+
+
+template <size_t s, size_t a, size_t ss>
+void* node_pool<s, a, ss>::allocate()
+{
+    auto& l = local();
+    if (!l.free) refill(l);
+
+    auto temp = l.free;
+    l.free    = temp->next;
+    --l.size;
+    return temp;
+}
+
+template <size_t s, size_t a, size_t ss>
+void node_pool<s, a, ss>::deallocate(void* ptr)
+{
+    auto  node = static_cast<free_node*>(ptr);
+    auto& l    = local();
+    if (l.exited)
+    {
+        node->next = nullptr;
+        push_global(node, 1);
+        return;
+    }
+
+    node->next = l.free;
+    l.free     = node;
+    if (++l.size < max_local) return;
+
+    // spill the oldest nodes (everything after the first slab worth)
+    auto last = l.free;
+    for (size_t i = 1; i < ss; ++i) last = last->next;
+    push_global(last->next, l.size - ss);
+    last->next = nullptr;
+    l.size     = ss;
+}
+
+// moves a chain of n nodes (ending in nullptr) into the shared free list
+template <size_t s, size_t a, size_t ss>
+void node_pool<s, a, ss>::push_global(free_node* first, size_t n)
+{
+    auto last = first;
+    for (size_t i = 1; i < n; ++i) last = last->next;
+
+    auto&                       g = global();
+    std::lock_guard<std::mutex> lock(g.mutex);
+    last->next = g.free;
+    g.free     = first;
+}
+
+template <size_t s, size_t a, size_t ss>
+void node_pool<s, a, ss>::refill(local_pool& l)
+{
+    auto& g = global();
+    {
+        std::lock_guard<std::mutex> lock(g.mutex);
+        while (g.free && l.size < ss)
+        {
+            auto temp  = g.free;
+            g.free     = temp->next;
+            temp->next = l.free;
+            l.free     = temp;
+            ++l.size;
+        }
+        if (l.free) return;
+    }
+
+    auto slab = static_cast<char*>(
+        ::operator new(node_size * ss, std::align_val_t(node_align)));
+    {
+        std::lock_guard<std::mutex> lock(g.mutex);
+        g.slabs.push_back(slab);
+    }
+    for (size_t i = ss; i-- > 0;)
+    {
+        auto temp  = reinterpret_cast<free_node*>(slab + i * node_size);
+        temp->next = l.free;
+        l.free     = temp;
+    }
+    l.size = ss;
+}
+
+} // namespace allocators_tm
+} // namespace utils_tm
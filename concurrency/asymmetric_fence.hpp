@@ -0,0 +1,89 @@
+#pragma once
+
+/*******************************************************************************
+ * asymmetric_fence.hpp
+ *
+ * Fence policies for algorithms with a frequent (light) and a rare (heavy)
+ * side, e.g., hazard pointers, where each protect has to order its
+ * announcement before the validating load, but only the reclaimer has to see
+ * these announcements.
+ *
+ * symmetric_fence_policy:  both sides use a sequentially consistent fence.
+ * asymmetric_fence_policy: the light side is only a compiler fence, the heavy
+ *   side uses membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED), which forces a
+ *   full memory barrier on all running threads of the process.  If membarrier
+ *   is not available (non Linux, or old kernels), both sides fall back to
+ *   sequentially consistent fences.
+ *
+ * A membarrier costs a system call and interrupts all running threads of the
+ * process, thus, the heavy side should batch its work (is_asymmetric).
+ ******************************************************************************/
+
+#include <atomic>
+
+#include "memory_order.hpp"
+
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace utils_tm
+{
+namespace concurrency_tm
+{
+
+struct symmetric_fence_policy
+{
+    static constexpr bool is_asymmetric = false;
+
+    static inline void light() { std::atomic_thread_fence(mo_seq_cst); }
+    static inline void heavy() { std::atomic_thread_fence(mo_seq_cst); }
+};
+
+namespace membarrier_detail
+{
+// registers the process for expedited membarriers (once, on startup)
+inline bool register_membarrier()
+{
+#if defined(__linux__) && defined(__NR_membarrier)
+    long cmds = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+    if (cmds < 0 || !(cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) return false;
+    return syscall(__NR_membarrier,
+                   MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+inline const bool available = register_membarrier();
+} // namespace membarrier_detail
+
+struct asymmetric_fence_policy
+{
+    static constexpr bool is_asymmetric = true;
+
+    static inline void light()
+    {
+        if (membarrier_detail::available)
+            std::atomic_signal_fence(mo_seq_cst);
+        else
+            std::atomic_thread_fence(mo_seq_cst);
+    }
+
+    static inline void heavy()
+    {
+#if defined(__linux__) && defined(__NR_membarrier)
+        if (membarrier_detail::available)
+        {
+            syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+            return;
+        }
+#endif
+        std::atomic_thread_fence(mo_seq_cst);
+    }
+};
+
+} // namespace concurrency_tm
+} // namespace utils_tm
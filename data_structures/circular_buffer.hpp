@@ -3,8 +3,13 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 namespace utils_tm
 {
@@ -49,6 +54,17 @@ class circular_buffer
     inline std::optional<T> pop_back();
     inline std::optional<T> pop_front();
 
+    template <class InputIt>
+    inline void append(InputIt first, InputIt last);
+    // moves up to n elements from the front to out, returns their number
+    template <class OutputIt>
+    inline size_t pop_front_n(OutputIt out, size_t n);
+
+    // the contents in order, the second span is only non-empty if the
+    // contents wrap around the end of the underlying array
+    inline std::pair<std::span<T>, std::span<T>>             as_spans();
+    inline std::pair<std::span<const T>, std::span<const T>> as_spans() const;
+
     size_t         size() const;
     size_t         capacity() const;
     allocator_type get_allocator() const { return _allocator; }
@@ -117,6 +133,8 @@ class circular_buffer
     inline size_t dec(size_t i, size_t diff = 1) const { return i - diff; }
 
     inline size_t compare_offsets(size_t lhs, size_t rhs) const;
+    inline void   destroy(T* first, T* last);
+    inline void   relocate(T* first, T* last, T* target);
 
     void grow();
     void cleanup();
@@ -150,7 +168,7 @@ circular_buffer<T, A>::circular_buffer(allocator_type alloc)
 template <class T, class A>
 circular_buffer<T, A>::circular_buffer(const circular_buffer& other,
                                        allocator_type         alloc)
-    : _allocator(alloc), //
+    : _allocator(alloc), _start(1ull << 31), _end(1ull << 31),
       _bitmask(other._bitmask)
 {
     _buffer = alloc_traits::allocate(_allocator, _bitmask + 1);
@@ -172,7 +190,8 @@ circular_buffer<T, A>::operator=(const circular_buffer& other)
 
 template <class T, class A>
 circular_buffer<T, A>::circular_buffer(circular_buffer&& other) noexcept
-    : _bitmask(other._bitmask), _buffer(other._buffer)
+    : _allocator(std::move(other._allocator)), _start(other._start),
+      _end(other._end), _bitmask(other._bitmask), _buffer(other._buffer)
 {
     other._buffer = nullptr;
 }
@@ -180,7 +199,7 @@ circular_buffer<T, A>::circular_buffer(circular_buffer&& other) noexcept
 template <class T, class A>
 circular_buffer<T, A>::circular_buffer(circular_buffer&& other,
                                        allocator_type    alloc) noexcept
-    : allocator_type(std::move(alloc)), //
+    : _allocator(std::move(alloc)), _start(other._start), _end(other._end),
       _bitmask(other._bitmask), _buffer(other._buffer)
 {
     other._buffer = nullptr;
@@ -280,6 +299,66 @@ std::optional<T> circular_buffer<T, A>::pop_front()
     return result;
 }
 
+template <class T, class A>
+template <class InputIt>
+void circular_buffer<T, A>::append(InputIt first, InputIt last)
+{
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>)
+    {
+        for (; first != last; ++first) emplace_back(*first);
+    }
+    else
+    {
+        size_t n = std::distance(first, last);
+        while (size() + n > capacity()) grow();
+
+        // fill the free space behind _end, then the free space at the front
+        size_t pos   = mod(_end);
+        size_t chunk = std::min(n, capacity() - pos);
+        for (size_t i = 0; i < chunk; ++i, ++first)
+            alloc_traits::construct(_allocator, _buffer + pos + i, *first);
+        for (size_t i = 0; i < n - chunk; ++i, ++first)
+            alloc_traits::construct(_allocator, _buffer + i, *first);
+        _end = inc(_end, n);
+    }
+}
+
+template <class T, class A>
+template <class OutputIt>
+size_t circular_buffer<T, A>::pop_front_n(OutputIt out, size_t n)
+{
+    auto [first, second] = as_spans();
+    size_t k             = std::min(n, size());
+    size_t k0            = std::min(k, first.size());
+
+    out = std::move(first.data(), first.data() + k0, out);
+    destroy(first.data(), first.data() + k0);
+    std::move(second.data(), second.data() + (k - k0), out);
+    destroy(second.data(), second.data() + (k - k0));
+    _start = inc(_start, k);
+    return k;
+}
+
+template <class T, class A>
+std::pair<std::span<T>, std::span<T>> circular_buffer<T, A>::as_spans()
+{
+    size_t pos   = mod(_start);
+    size_t chunk = std::min(size(), capacity() - pos);
+    return std::make_pair(std::span<T>(_buffer + pos, chunk),
+                          std::span<T>(_buffer, size() - chunk));
+}
+
+template <class T, class A>
+std::pair<std::span<const T>, std::span<const T>>
+circular_buffer<T, A>::as_spans() const
+{
+    size_t pos   = mod(_start);
+    size_t chunk = std::min(size(), capacity() - pos);
+    return std::make_pair(std::span<const T>(_buffer + pos, chunk),
+                          std::span<const T>(_buffer, size() - chunk));
+}
+
 
 // SIZE AND CAPACITY !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 template <class T, class A>
@@ -304,35 +383,61 @@ size_t circular_buffer<T, A>::compare_offsets(size_t lhs, size_t rhs) const
 }
 
 template <class T, class A>
-void circular_buffer<T, A>::grow()
+void circular_buffer<T, A>::destroy(T* first, T* last)
 {
-    auto nbitmask = (_bitmask << 1) + 1;
-    // auto nbuffer  = static_cast<T*>(malloc(sizeof(T) * (nbitmask + 1)));
-    auto nbuffer = alloc_traits::allocate(_allocator, nbitmask + 1);
+    if constexpr (std::is_trivially_destructible_v<T>) return;
+    for (; first != last; ++first) alloc_traits::destroy(_allocator, first);
+}
 
-    size_t i = 0;
-    for (iterator it = begin(); it != end(); ++it)
+// moves the elements from [first, last) into uninitialized memory at target
+template <class T, class A>
+void circular_buffer<T, A>::relocate(T* first, T* last, T* target)
+{
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        if (first != last)
+            std::memcpy(static_cast<void*>(target), first,
+                        (last - first) * sizeof(T));
+    }
+    else
     {
-        nbuffer[i++] = std::move(*it);
-        it->~T();
+        for (; first != last; ++first, ++target)
+        {
+            alloc_traits::construct(_allocator, target, std::move(*first));
+            alloc_traits::destroy(_allocator, first);
+        }
     }
+}
+
+// the contents are relocated to the front of the new buffer (in two parts,
+// if they wrap around the end of the old buffer)
+template <class T, class A>
+void circular_buffer<T, A>::grow()
+{
+    auto nbitmask = (_bitmask << 1) + 1;
+    auto nbuffer  = alloc_traits::allocate(_allocator, nbitmask + 1);
+    auto n        = size();
+
+    auto [first, second] = as_spans();
+    relocate(first.data(), first.data() + first.size(), nbuffer);
+    relocate(second.data(), second.data() + second.size(),
+             nbuffer + first.size());
 
-    // free(_buffer);
     alloc_traits::deallocate(_allocator, _buffer, _bitmask + 1);
-    _start   = 0;
-    _end     = i;
+    // the new start has to be aligned to the new capacity
+    _start   = std::max(_start & ~nbitmask, nbitmask + 1);
+    _end     = _start + n;
     _bitmask = nbitmask;
     _buffer  = nbuffer;
 }
 
+// only the slots between _start and _end contain elements
 template <class T, class A>
 void circular_buffer<T, A>::cleanup()
 {
-    for (pointer it = _buffer; it <= _buffer + _bitmask; ++it)
-    {
-        // it->~T();
-        alloc_traits::destroy(_allocator, it);
-    }
+    auto [first, second] = as_spans();
+    destroy(first.data(), first.data() + first.size());
+    destroy(second.data(), second.data() + second.size());
     _start = _end = 0;
 }
 
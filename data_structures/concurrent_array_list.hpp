@@ -0,0 +1,394 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+#include "../concurrency/memory_order.hpp"
+
+namespace utils_tm
+{
+
+// Append only container, elements are stored in a singly linked list of
+// blocks.  The append position is stored in one 64bit word
+// (upper 48bits = pointer to the current block,
+//  lower 16bits = offset within the current block).
+// Thus, appending is usually one fetch_add.  The thread that increments the
+// offset to exactly block_size allocates the next block, all other threads
+// that overflow the current block wait for the new block to be published.
+//
+// Elements can only be accessed by iterating through the container, this
+// should not happen concurrently to appends.
+template <class T, class Allocator = std::allocator<T>, size_t BlockSize = 1024>
+class concurrent_array_list
+{
+  private:
+    using this_type = concurrent_array_list<T, Allocator, BlockSize>;
+    using memo      = concurrency_tm::standard_memory_order_policy;
+
+    static_assert(BlockSize > 0 && BlockSize <= (1ull << 15),
+                  "block_size has to fit into the lower 16 bits");
+
+    static constexpr size_t _block_size  = BlockSize;
+    static constexpr size_t _offset_bits = 16;
+    static constexpr size_t _offset_mask = (1ull << _offset_bits) - 1;
+
+    class block_type
+    {
+      public:
+        block_type() : next(nullptr) {}
+        ~block_type() {}
+
+        inline T* elements() { return &_elements[0]; }
+
+        std::atomic<block_type*> next;
+
+      private:
+        union
+        {
+            T _elements[_block_size];
+        };
+    };
+
+    template <bool is_const>
+    class iterator_base
+    {
+      private:
+        using this_type = iterator_base<is_const>;
+        block_type* _block;
+        size_t      _off;
+
+      public:
+        using difference_type = std::ptrdiff_t;
+        using value_type =
+            typename std::conditional<is_const, const T, T>::type;
+        using reference         = value_type&;
+        using pointer           = value_type*;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator_base(block_type* block, size_t off) : _block(block), _off(off)
+        {
+        }
+        iterator_base(const iterator_base& other)            = default;
+        iterator_base& operator=(const iterator_base& other) = default;
+        ~iterator_base()                                     = default;
+
+        inline reference operator*() const;
+        inline pointer   operator->() const;
+
+        inline iterator_base& operator++();
+
+        inline bool operator==(const iterator_base& other) const;
+        inline bool operator!=(const iterator_base& other) const;
+    };
+
+  public:
+    using value_type          = T;
+    using reference_type      = T&;
+    using pointer_type        = T*;
+    using iterator_type       = iterator_base<false>;
+    using const_iterator_type = iterator_base<true>;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::rebind_alloc<T>;
+
+  private:
+    using internal_allocator_type = typename std::allocator_traits<
+        Allocator>::rebind_alloc<block_type>;
+    using internal_alloc_traits = std::allocator_traits<internal_allocator_type>;
+    using alloc_traits          = std::allocator_traits<allocator_type>;
+
+    [[no_unique_address]] allocator_type          _element_allocator;
+    [[no_unique_address]] internal_allocator_type _allocator;
+    std::atomic<block_type*>                      _first;
+    std::atomic_size_t                            _pos;
+
+  public:
+    explicit concurrent_array_list(allocator_type alloc = {})
+        : _element_allocator(alloc), _allocator(alloc), _first(nullptr),
+          _pos(0)
+    {
+    }
+
+    concurrent_array_list(const concurrent_array_list&)            = delete;
+    concurrent_array_list& operator=(const concurrent_array_list&) = delete;
+
+    concurrent_array_list(concurrent_array_list&& source) noexcept;
+    concurrent_array_list& operator=(concurrent_array_list&& source) noexcept;
+
+    ~concurrent_array_list();
+
+    template <class... Args>
+    inline void emplace_back(Args&&... args);
+    inline void push_back(const T& element);
+
+    size_t         size() const;
+    allocator_type get_allocator() const { return _element_allocator; }
+
+    inline iterator_type       begin();
+    inline const_iterator_type begin() const;
+    inline const_iterator_type cbegin() const;
+    inline iterator_type       end();
+    inline const_iterator_type end() const;
+    inline const_iterator_type cend() const;
+
+  private:
+    static inline block_type* get_block(size_t pos);
+    static inline size_t      get_offset(size_t pos);
+    static inline size_t      make_pos(block_type* block, size_t offset);
+    static inline size_t      block_capacity(block_type* block);
+
+    inline T*                 reserve();
+    inline block_type*        end_block(size_t& offset) const;
+};
+
+
+
+template <class T, class A, size_t bs>
+concurrent_array_list<T, A, bs>::concurrent_array_list(
+    concurrent_array_list&& source) noexcept
+    : _element_allocator(source._element_allocator),
+      _allocator(source._allocator),
+      _first(source._first.exchange(nullptr, memo::acq_rel)),
+      _pos(source._pos.exchange(0, memo::acq_rel))
+{
+}
+
+template <class T, class A, size_t bs>
+concurrent_array_list<T, A, bs>&
+concurrent_array_list<T, A, bs>::operator=(
+    concurrent_array_list&& source) noexcept
+{
+    if (this == &source) return *this;
+    this->~concurrent_array_list();
+    new (this) concurrent_array_list(std::move(source));
+    return *this;
+}
+
+template <class T, class A, size_t bs>
+concurrent_array_list<T, A, bs>::~concurrent_array_list()
+{
+    size_t last_offset = 0;
+    auto   last        = end_block(last_offset);
+    auto   temp        = _first.exchange(nullptr, memo::relaxed);
+    while (temp)
+    {
+        auto next = temp->next.load(memo::relaxed);
+        auto size = (next || temp != last) ? _block_size : last_offset;
+        auto ptr  = temp->elements();
+        for (size_t i = 0; i < size; ++i)
+        {
+            alloc_traits::destroy(_element_allocator, ptr + i);
+        }
+        internal_alloc_traits::destroy(_allocator, temp);
+        internal_alloc_traits::deallocate(_allocator, temp, 1);
+        temp = next;
+    }
+    _pos.store(0, memo::relaxed);
+}
+
+
+
+template <class T, class A, size_t bs>
+template <class... Args>
+void concurrent_array_list<T, A, bs>::emplace_back(Args&&... args)
+{
+    alloc_traits::construct(_element_allocator, reserve(),
+                            std::forward<Args>(args)...);
+}
+
+template <class T, class A, size_t bs>
+void concurrent_array_list<T, A, bs>::push_back(const T& element)
+{
+    alloc_traits::construct(_element_allocator, reserve(), element);
+}
+
+template <class T, class A, size_t bs>
+size_t concurrent_array_list<T, A, bs>::size() const
+{
+    size_t last_offset = 0;
+    auto   last        = end_block(last_offset);
+    size_t result      = 0;
+    for (auto temp = _first.load(memo::acquire); temp;
+         temp      = temp->next.load(memo::acquire))
+    {
+        if (temp == last) return result + last_offset;
+        result += _block_size;
+    }
+    return result;
+}
+
+
+
+// HELPER FUNCTIONS
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::block_type*
+concurrent_array_list<T, A, bs>::get_block(size_t pos)
+{
+    return reinterpret_cast<block_type*>(pos >> _offset_bits);
+}
+
+template <class T, class A, size_t bs>
+size_t concurrent_array_list<T, A, bs>::get_offset(size_t pos)
+{
+    return pos & _offset_mask;
+}
+
+template <class T, class A, size_t bs>
+size_t concurrent_array_list<T, A, bs>::make_pos(block_type* block,
+                                                 size_t      offset)
+{
+    return (reinterpret_cast<size_t>(block) << _offset_bits) | offset;
+}
+
+// before the first append there is no block (i.e. nullptr without capacity)
+template <class T, class A, size_t bs>
+size_t concurrent_array_list<T, A, bs>::block_capacity(block_type* block)
+{
+    return (block) ? _block_size : 0;
+}
+
+// returns a pointer to uninitialized memory for one element
+template <class T, class A, size_t bs>
+T* concurrent_array_list<T, A, bs>::reserve()
+{
+    while (true)
+    {
+        auto pos    = _pos.fetch_add(1, memo::acq_rel);
+        auto block  = get_block(pos);
+        auto offset = get_offset(pos);
+        auto cap    = block_capacity(block);
+
+        if (offset < cap) return block->elements() + offset;
+
+        if (offset == cap)
+        {
+            // we were the first to overflow the block -> append a new block
+            // and take its first element
+            auto nblock = internal_alloc_traits::allocate(_allocator, 1);
+            internal_alloc_traits::construct(_allocator, nblock);
+            if (block) block->next.store(nblock, memo::release);
+            else _first.store(nblock, memo::release);
+            _pos.store(make_pos(nblock, 1), memo::release);
+            return nblock->elements();
+        }
+
+        // wait until the new block is published
+        while (get_block(_pos.load(memo::acquire)) == block)
+        { /* wait */
+        }
+    }
+}
+
+// returns the last block and the number of elements it contains
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::block_type*
+concurrent_array_list<T, A, bs>::end_block(size_t& offset) const
+{
+    auto pos = _pos.load(memo::acquire);
+    offset   = std::min(get_offset(pos), block_capacity(get_block(pos)));
+    return get_block(pos);
+}
+
+
+
+// ITERATOR STUFF
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::iterator_type
+concurrent_array_list<T, A, bs>::begin()
+{
+    return iterator_type(_first.load(memo::acquire), 0);
+}
+
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::const_iterator_type
+concurrent_array_list<T, A, bs>::begin() const
+{
+    return cbegin();
+}
+
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::const_iterator_type
+concurrent_array_list<T, A, bs>::cbegin() const
+{
+    return const_iterator_type(_first.load(memo::acquire), 0);
+}
+
+// a full last block ends like any other block (in nullptr, 0)
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::iterator_type
+concurrent_array_list<T, A, bs>::end()
+{
+    size_t offset = 0;
+    auto   block  = end_block(offset);
+    if (offset == _block_size) return iterator_type(nullptr, 0);
+    return iterator_type(block, offset);
+}
+
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::const_iterator_type
+concurrent_array_list<T, A, bs>::end() const
+{
+    return cend();
+}
+
+template <class T, class A, size_t bs>
+typename concurrent_array_list<T, A, bs>::const_iterator_type
+concurrent_array_list<T, A, bs>::cend() const
+{
+    size_t offset = 0;
+    auto   block  = end_block(offset);
+    if (offset == _block_size) return const_iterator_type(nullptr, 0);
+    return const_iterator_type(block, offset);
+}
+
+
+
+// ITERATOR IMPLEMENTATION
+template <class T, class A, size_t bs>
+template <bool c>
+typename concurrent_array_list<T, A, bs>::template iterator_base<c>::reference
+concurrent_array_list<T, A, bs>::iterator_base<c>::operator*() const
+{
+    return _block->elements()[_off];
+}
+
+template <class T, class A, size_t bs>
+template <bool c>
+typename concurrent_array_list<T, A, bs>::template iterator_base<c>::pointer
+concurrent_array_list<T, A, bs>::iterator_base<c>::operator->() const
+{
+    return _block->elements() + _off;
+}
+
+template <class T, class A, size_t bs>
+template <bool c>
+typename concurrent_array_list<T, A, bs>::template iterator_base<
+    c>::iterator_base&
+concurrent_array_list<T, A, bs>::iterator_base<c>::operator++()
+{
+    if (++_off == _block_size)
+    {
+        _block = _block->next.load(memo::acquire);
+        _off   = 0;
+    }
+    return *this;
+}
+
+template <class T, class A, size_t bs>
+template <bool c>
+bool concurrent_array_list<T, A, bs>::iterator_base<c>::operator==(
+    const iterator_base& other) const
+{
+    return _block == other._block && _off == other._off;
+}
+
+template <class T, class A, size_t bs>
+template <bool c>
+bool concurrent_array_list<T, A, bs>::iterator_base<c>::operator!=(
+    const iterator_base& other) const
+{
+    return _block != other._block || _off != other._off;
+}
+} // namespace utils_tm
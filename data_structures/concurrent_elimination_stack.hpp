@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "../concurrency/memory_order.hpp"
+#include "../fastrange.hpp"
+#include "concurrent_singly_linked_list.hpp"
+
+namespace utils_tm
+{
+
+// Stack based on concurrent_singly_linked_list with an elimination array.
+// Whenever a push fails its CAS on the list head, it offers its item in a
+// random slot of the elimination array and waits for a pop to take it.  Pops
+// look for an offered item before they access the list.  Thus, concurrent
+// push/pop pairs do not have to touch the contended list head.
+template <class T,
+          class Allocator                = std::allocator<T>,
+          template <class> class RecMngr = reclamation_tm::hazard_manager,
+          size_t NumSlots                = 16>
+class concurrent_elimination_stack
+{
+  private:
+    using this_type =
+        concurrent_elimination_stack<T, Allocator, RecMngr, NumSlots>;
+    using memo      = concurrency_tm::standard_memory_order_policy;
+    using list_type = concurrent_singly_linked_list<T, Allocator, RecMngr>;
+
+    using queue_item_type = typename list_type::queue_item_type;
+    using queue_item_ptr  = queue_item_type*;
+
+    using internal_allocator_type = typename std::allocator_traits<
+        Allocator>::rebind_alloc<queue_item_type>;
+    using alloc_traits = std::allocator_traits<internal_allocator_type>;
+
+    struct alignas(64) slot_type
+    {
+        std::atomic<queue_item_ptr> item{nullptr};
+    };
+
+  public:
+    using value_type     = T;
+    using allocator_type = typename list_type::allocator_type;
+    using reclamation_manager_type =
+        typename list_type::reclamation_manager_type;
+    using reclamation_handle_type =
+        typename list_type::reclamation_handle_type;
+
+    static constexpr size_t num_slots = NumSlots;
+
+    explicit concurrent_elimination_stack(size_t         wait_iterations = 128,
+                                          allocator_type alloc           = {})
+        : _list(alloc), _allocator(alloc), _wait_iterations(wait_iterations),
+          _size(0)
+    {
+    }
+    concurrent_elimination_stack(const concurrent_elimination_stack&) = delete;
+    concurrent_elimination_stack&
+    operator=(const concurrent_elimination_stack&) = delete;
+    ~concurrent_elimination_stack();
+
+    template <class... Args>
+    inline void             emplace(Args&&... args);
+    inline void             push(const T& element);
+    inline std::optional<T> pop(reclamation_handle_type& h);
+
+    // not linearizable, counts the items in the list (offered items are not
+    // counted), the list itself cannot be traversed safely while elements
+    // are popped and reclaimed
+    size_t size() const
+    {
+        auto temp = _size.load(memo::relaxed);
+        return (temp > 0) ? size_t(temp) : 0;
+    }
+
+  private:
+    list_type                                     _list;
+    [[no_unique_address]] internal_allocator_type _allocator;
+    size_t                                        _wait_iterations;
+    // a pop can decrement before the matching push increments
+    alignas(64) std::atomic<std::ptrdiff_t>       _size;
+    slot_type                                     _slots[NumSlots];
+
+    inline void           push(queue_item_ptr item);
+    inline bool           offer(queue_item_ptr item);
+    inline queue_item_ptr take();
+    static inline size_t  random_slot();
+};
+
+
+
+template <class T, class A, template <class> class R, size_t ns>
+concurrent_elimination_stack<T, A, R, ns>::~concurrent_elimination_stack()
+{
+    // there should be no offers without concurrent pushes
+    for (auto& slot : _slots)
+    {
+        auto temp = slot.item.exchange(nullptr, memo::relaxed);
+        if (!temp) continue;
+        alloc_traits::destroy(_allocator, temp);
+        alloc_traits::deallocate(_allocator, temp, 1);
+    }
+}
+
+template <class T, class A, template <class> class R, size_t ns>
+template <class... Args>
+void concurrent_elimination_stack<T, A, R, ns>::emplace(Args&&... args)
+{
+    queue_item_ptr item = alloc_traits::allocate(_allocator, 1);
+    alloc_traits::construct(_allocator, item, std::forward<Args>(args)...);
+    push(item);
+}
+
+template <class T, class A, template <class> class R, size_t ns>
+void concurrent_elimination_stack<T, A, R, ns>::push(const T& element)
+{
+    queue_item_ptr item = alloc_traits::allocate(_allocator, 1);
+    alloc_traits::construct(_allocator, item, element);
+    push(item);
+}
+
+template <class T, class A, template <class> class R, size_t ns>
+std::optional<T>
+concurrent_elimination_stack<T, A, R, ns>::pop(reclamation_handle_type& h)
+{
+    auto item = take();
+    if (!item)
+    {
+        auto result = _list.pop_front(h);
+        if (result) _size.fetch_sub(1, memo::relaxed);
+        return result;
+    }
+
+    // the item was never visible in the list -> no reclamation necessary
+    auto result = std::optional<T>(std::move(item->value));
+    alloc_traits::destroy(_allocator, item);
+    alloc_traits::deallocate(_allocator, item, 1);
+    return result;
+}
+
+
+
+// HELPER FUNCTIONS
+template <class T, class A, template <class> class R, size_t ns>
+void concurrent_elimination_stack<T, A, R, ns>::push(queue_item_ptr item)
+{
+    while (true)
+    {
+        if (_list.try_push(item))
+        {
+            _size.fetch_add(1, memo::relaxed);
+            return;
+        }
+        // the list head is contended -> try to find a pop partner
+        if (offer(item)) return;
+    }
+}
+
+// returns true if the item was taken by a pop
+template <class T, class A, template <class> class R, size_t ns>
+bool concurrent_elimination_stack<T, A, R, ns>::offer(queue_item_ptr item)
+{
+    auto&          slot = _slots[random_slot()].item;
+    queue_item_ptr temp = nullptr;
+    if (!slot.compare_exchange_strong(temp, item, memo::acq_rel)) return false;
+
+    for (size_t i = 0; i < _wait_iterations; ++i)
+    {
+        if (slot.load(memo::acquire) != item) return true;
+    }
+
+    // withdraw the offer, fails if it was taken in the meantime
+    temp = item;
+    return !slot.compare_exchange_strong(temp, nullptr, memo::acq_rel);
+}
+
+template <class T, class A, template <class> class R, size_t ns>
+typename concurrent_elimination_stack<T, A, R, ns>::queue_item_ptr
+concurrent_elimination_stack<T, A, R, ns>::take()
+{
+    auto& slot = _slots[random_slot()].item;
+    auto  temp = slot.load(memo::acquire);
+    if (!temp) return nullptr;
+    if (!slot.compare_exchange_strong(temp, nullptr, memo::acq_rel))
+        return nullptr;
+    return temp;
+}
+
+template <class T, class A, template <class> class R, size_t ns>
+size_t concurrent_elimination_stack<T, A, R, ns>::random_slot()
+{
+    // xorshift seeded with the address of the thread local state
+    thread_local size_t state = reinterpret_cast<size_t>(&state) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return fastrange64(ns, state);
+}
+
+} // namespace utils_tm
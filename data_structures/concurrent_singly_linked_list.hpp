@@ -1,21 +1,38 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <iterator>
 #include <memory>
+#include <optional>
+#include <type_traits>
 
 #include "../concurrency/memory_order.hpp"
+#include "../mark_pointer.hpp"
+#include "../memory_reclamation/hazard_reclamation.hpp"
+#include "../memory_reclamation/reclamation_guard.hpp"
 
 namespace utils_tm
 {
 
-template <class T, class Allocator = std::allocator<T>>
+// Elements can be pushed and iterated concurrently.  Removing elements
+// (pop_front and erase) uses Harris style logical deletion (the next pointer
+// of a removed element is marked) and hands unlinked elements to the
+// reclamation manager RecMngr.  Nodes are allocated with the list's
+// allocator, therefore, the reclamation manager has to use a compatible
+// allocator (counting_manager cannot be used, since it has to create all
+// protected objects itself).  Iterators are unprotected, they should not be
+// used concurrently to removals.
+template <class T,
+          class Allocator                = std::allocator<T>,
+          template <class> class RecMngr = reclamation_tm::hazard_manager>
 class concurrent_singly_linked_list
 {
   private:
-    using this_type = concurrent_singly_linked_list<T>;
+    using this_type = concurrent_singly_linked_list<T, Allocator, RecMngr>;
     using memo      = concurrency_tm::standard_memory_order_policy;
 
+  public:
     class queue_item_type
     {
       public:
@@ -29,6 +46,7 @@ class concurrent_singly_linked_list
         std::atomic<queue_item_type*> next;
     };
 
+  private:
     template <bool is_const>
     class iterator_base
     {
@@ -69,14 +87,19 @@ class concurrent_singly_linked_list
     using const_iterator_type = iterator_base<true>;
     using allocator_type =
         typename std::allocator_traits<Allocator>::rebind_alloc<T>;
+    using reclamation_manager_type = RecMngr<queue_item_type>;
+    using reclamation_handle_type =
+        typename reclamation_manager_type::handle_type;
 
 
   private:
     using internal_allocator_type = typename std::allocator_traits<
         Allocator>::rebind_alloc<queue_item_type>;
-    using alloc_traits = std::allocator_traits<allocator_type>;
+    using alloc_traits = std::allocator_traits<internal_allocator_type>;
 
-    using queue_item_ptr = queue_item_type*;
+    using queue_item_ptr        = queue_item_type*;
+    using atomic_queue_item_ptr = std::atomic<queue_item_ptr>;
+    using guard_type            = typename reclamation_handle_type::guard_type;
 
     [[no_unique_address]] internal_allocator_type _allocator;
     std::atomic<queue_item_ptr>                   _head;
@@ -105,6 +128,13 @@ class concurrent_singly_linked_list
     inline void emplace(Args&&... args);
     inline void push(const T& element);
     inline void push(queue_item_type* item);
+    inline void push(queue_item_type* first, queue_item_type* last);
+    template <class Iterator>
+    inline void push(Iterator first, Iterator last);
+    inline bool try_push(queue_item_type* item);
+
+    inline std::optional<T> pop_front(reclamation_handle_type& h);
+    inline size_t           erase(reclamation_handle_type& h, const T& element);
 
     iterator_type find(const T& element);
     bool          contains(const T& element);
@@ -118,12 +148,21 @@ class concurrent_singly_linked_list
     inline iterator_type       end();
     inline const_iterator_type end() const;
     inline const_iterator_type cend() const;
+
+  private:
+    inline bool unlink(reclamation_handle_type& h,
+                       atomic_queue_item_ptr&   link,
+                       queue_item_ptr           curr,
+                       queue_item_ptr           next);
+    inline void cleanup(reclamation_handle_type& h,
+                        guard_type&              prev,
+                        queue_item_ptr           target);
 };
 
 
 
-template <class T, class A>
-concurrent_singly_linked_list<T, A>::concurrent_singly_linked_list(
+template <class T, class A, template <class> class R>
+concurrent_singly_linked_list<T, A, R>::concurrent_singly_linked_list(
     const concurrent_singly_linked_list& source, allocator_type alloc)
     : _allocator(alloc)
 {
@@ -138,9 +177,9 @@ concurrent_singly_linked_list<T, A>::concurrent_singly_linked_list(
     }
 }
 
-template <class T, class A>
-concurrent_singly_linked_list<T, A>&
-concurrent_singly_linked_list<T, A>::operator=(
+template <class T, class A, template <class> class R>
+concurrent_singly_linked_list<T, A, R>&
+concurrent_singly_linked_list<T, A, R>::operator=(
     const concurrent_singly_linked_list& source)
 {
     if (this == &source) return *this;
@@ -151,25 +190,25 @@ concurrent_singly_linked_list<T, A>::operator=(
 
 
 
-template <class T, class A>
-concurrent_singly_linked_list<T, A>::concurrent_singly_linked_list(
+template <class T, class A, template <class> class R>
+concurrent_singly_linked_list<T, A, R>::concurrent_singly_linked_list(
     concurrent_singly_linked_list&& source) noexcept
     : _allocator(source._allocator),
       _head(source._head.exchange(nullptr, memo::acq_rel))
 {
 }
 
-template <class T, class A>
-concurrent_singly_linked_list<T, A>::concurrent_singly_linked_list(
+template <class T, class A, template <class> class R>
+concurrent_singly_linked_list<T, A, R>::concurrent_singly_linked_list(
     concurrent_singly_linked_list&& source, allocator_type alloc) noexcept
     : _allocator(alloc), //
       _head(source._head.exchange(nullptr, memo::acq_rel))
 {
 }
 
-template <class T, class A>
-concurrent_singly_linked_list<T, A>&
-concurrent_singly_linked_list<T, A>::operator=(
+template <class T, class A, template <class> class R>
+concurrent_singly_linked_list<T, A, R>&
+concurrent_singly_linked_list<T, A, R>::operator=(
     concurrent_singly_linked_list&& source) noexcept
 {
     if (this == &source) return *this;
@@ -179,13 +218,13 @@ concurrent_singly_linked_list<T, A>::operator=(
 }
 
 
-template <class T, class A>
-concurrent_singly_linked_list<T, A>::~concurrent_singly_linked_list()
+template <class T, class A, template <class> class R>
+concurrent_singly_linked_list<T, A, R>::~concurrent_singly_linked_list()
 {
     auto temp = _head.exchange(nullptr, memo::relaxed);
     while (temp)
     {
-        auto next = temp->next.load(memo::relaxed);
+        auto next = mark::clear(temp->next.load(memo::relaxed));
         // delete temp;
         alloc_traits::destroy(_allocator, temp);
         alloc_traits::deallocate(_allocator, temp, 1);
@@ -195,9 +234,9 @@ concurrent_singly_linked_list<T, A>::~concurrent_singly_linked_list()
 
 
 
-template <class T, class A>
+template <class T, class A, template <class> class R>
 template <class... Args>
-void concurrent_singly_linked_list<T, A>::emplace(Args&&... args)
+void concurrent_singly_linked_list<T, A, R>::emplace(Args&&... args)
 {
     // queue_item_type* item = new queue_item_type(std::forward<Args>(args)...);
     queue_item_type* item = alloc_traits::allocate(_allocator, 1);
@@ -205,8 +244,8 @@ void concurrent_singly_linked_list<T, A>::emplace(Args&&... args)
     push(item);
 }
 
-template <class T, class A>
-void concurrent_singly_linked_list<T, A>::push(const T& element)
+template <class T, class A, template <class> class R>
+void concurrent_singly_linked_list<T, A, R>::push(const T& element)
 {
     // queue_item_type* item = new queue_item_type{element};
     queue_item_type* item = alloc_traits::allocate(_allocator, 1);
@@ -214,8 +253,8 @@ void concurrent_singly_linked_list<T, A>::push(const T& element)
     push(item);
 }
 
-template <class T, class A>
-void concurrent_singly_linked_list<T, A>::push(queue_item_type* item)
+template <class T, class A, template <class> class R>
+void concurrent_singly_linked_list<T, A, R>::push(queue_item_type* item)
 {
     auto temp = _head.load(memo::acquire);
     do {
@@ -223,23 +262,145 @@ void concurrent_singly_linked_list<T, A>::push(queue_item_type* item)
     } while (!_head.compare_exchange_weak(temp, item, memo::acq_rel));
 }
 
+// publishes a privately linked chain (first -> ... -> last) with one CAS
+template <class T, class A, template <class> class R>
+void concurrent_singly_linked_list<T, A, R>::push(queue_item_type* first,
+                                                  queue_item_type* last)
+{
+    auto temp = _head.load(memo::acquire);
+    do {
+        last->next.store(temp, memo::relaxed);
+    } while (!_head.compare_exchange_weak(temp, first, memo::acq_rel));
+}
+
+// the resulting order is the same as for individual pushes
+// (i.e. the last element of the range becomes the new head)
+template <class T, class A, template <class> class R>
+template <class Iterator>
+void concurrent_singly_linked_list<T, A, R>::push(Iterator first,
+                                                  Iterator last)
+{
+    if (first == last) return;
+
+    queue_item_type* tail = alloc_traits::allocate(_allocator, 1);
+    alloc_traits::construct(_allocator, tail, *first);
+    queue_item_type* head = tail;
+    for (++first; first != last; ++first)
+    {
+        queue_item_type* item = alloc_traits::allocate(_allocator, 1);
+        alloc_traits::construct(_allocator, item, *first);
+        item->next.store(head, memo::relaxed);
+        head = item;
+    }
+    push(head, tail);
+}
+
+// only one attempt, fails if _head changes concurrently
+template <class T, class A, template <class> class R>
+bool concurrent_singly_linked_list<T, A, R>::try_push(queue_item_type* item)
+{
+    auto temp = _head.load(memo::acquire);
+    item->next.store(temp, memo::relaxed);
+    return _head.compare_exchange_strong(temp, item, memo::acq_rel);
+}
+
+
+
+template <class T, class A, template <class> class R>
+std::optional<T> concurrent_singly_linked_list<T, A, R>::pop_front(
+    reclamation_handle_type& h)
+{
+    static_assert(std::is_same_v<typename reclamation_manager_type::
+                                     protected_type,
+                                 queue_item_type>,
+                  "the reclamation manager has to protect list items");
+
+    while (true)
+    {
+        auto curr = h.guard(_head);
+        if (!curr) return std::nullopt;
+
+        queue_item_ptr next = curr->next.load(memo::acquire);
+        // the first element is already removed -> help unlinking it
+        if (mark::is_marked(next))
+        {
+            unlink(h, _head, curr, next);
+            continue;
+        }
+
+        if (!mark::atomic_mark<0>(curr->next, next, memo::acq_rel)) continue;
+
+        // curr is logically deleted and still protected by our guard, if
+        // the unlink fails, curr is unlinked by the next pop_front or erase
+        // that passes it
+        auto result = std::optional<T>(curr->value);
+        unlink(h, _head, curr, next);
+        return result;
+    }
+}
+
+template <class T, class A, template <class> class R>
+size_t
+concurrent_singly_linked_list<T, A, R>::erase(reclamation_handle_type& h,
+                                              const T&                 element)
+{
+    static_assert(std::is_same_v<typename reclamation_manager_type::
+                                     protected_type,
+                                 queue_item_type>,
+                  "the reclamation manager has to protect list items");
 
+    while (true)
+    {
+        auto prev = guard_type(h);
+        auto curr = h.guard(_head);
 
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::iterator_type
-concurrent_singly_linked_list<T, A>::find(const T& element)
+        while (true)
+        {
+            // end of the list -> not found
+            if (!curr) return 0;
+
+            auto           next = h.guard(curr->next);
+            queue_item_ptr nptr = next;
+            auto&          link = (prev) ? prev->next : _head;
+
+            // curr is logically deleted -> help unlinking it and restart
+            if (mark::is_marked(nptr))
+            {
+                unlink(h, link, curr, nptr);
+                break;
+            }
+
+            if (curr->value == element)
+            {
+                if (!mark::atomic_mark<0>(curr->next, nptr, memo::acq_rel))
+                    break;
+                if (!unlink(h, link, curr, nptr)) cleanup(h, prev, curr);
+                return 1;
+            }
+
+            prev = std::move(curr);
+            curr = std::move(next);
+        }
+    }
+}
+
+
+
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::iterator_type
+concurrent_singly_linked_list<T, A, R>::find(const T& element)
 {
     return std::find(begin(), end(), element);
 }
 
-template <class T, class A>
-bool concurrent_singly_linked_list<T, A>::contains(const T& element)
+template <class T, class A, template <class> class R>
+bool concurrent_singly_linked_list<T, A, R>::contains(const T& element)
 {
     return find(element) != end();
 }
 
-template <class T, class A>
-size_t concurrent_singly_linked_list<T, A>::size() const
+template <class T, class A, template <class> class R>
+size_t concurrent_singly_linked_list<T, A, R>::size() const
 {
     auto result = 0;
     for ([[maybe_unused]] const auto& e : *this) { ++result; }
@@ -248,45 +409,115 @@ size_t concurrent_singly_linked_list<T, A>::size() const
 
 
 
+// HELPER FUNCTIONS
+// removes the logically deleted curr from the list by swinging the link that
+// points to it (either _head or the next pointer of its predecessor), the
+// successful thread hands curr to the reclamation manager
+template <class T, class A, template <class> class R>
+bool concurrent_singly_linked_list<T, A, R>::unlink(reclamation_handle_type& h,
+                                                    atomic_queue_item_ptr& link,
+                                                    queue_item_ptr curr,
+                                                    queue_item_ptr next)
+{
+    queue_item_ptr temp = curr;
+    if (!link.compare_exchange_strong(temp, mark::clear(next), memo::acq_rel))
+        return false;
+    h.safe_delete(curr);
+    return true;
+}
+
+// unlinks target (marked by us) after unlinking it from prev failed.  Elements
+// are only pushed at the head, thus, nothing is inserted behind prev.  The
+// walk restarts from prev (from the head once prev is removed itself), and
+// stops at target, or at its successor (then target was unlinked by someone
+// else).  Logically deleted elements on the way are unlinked.
+template <class T, class A, template <class> class R>
+void concurrent_singly_linked_list<T, A, R>::cleanup(reclamation_handle_type& h,
+                                                     guard_type&    prev,
+                                                     queue_item_ptr target)
+{
+    // target is marked, therefore, its next pointer cannot change anymore
+    queue_item_ptr tnext = mark::clear(target->next.load(memo::acquire));
+
+    while (true)
+    {
+        if (prev && mark::is_marked(prev->next.load(memo::acquire)))
+            prev = guard_type(h);
+
+        auto& plink = (prev) ? prev->next : _head;
+        auto  curr  = h.guard(plink);
+        if (plink.load(memo::acquire) != queue_item_ptr(curr)) continue;
+
+        bool restart = false;
+        while (curr && curr != target && curr != tnext)
+        {
+            auto           next = h.guard(curr->next);
+            queue_item_ptr nptr = next;
+
+            if (mark::is_marked(nptr))
+            {
+                auto& link = (prev) ? prev->next : _head;
+                if (!unlink(h, link, curr, nptr))
+                {
+                    restart = true;
+                    break;
+                }
+                curr = std::move(next);
+                curr.unmark();
+                continue;
+            }
+
+            prev = std::move(curr);
+            curr = std::move(next);
+        }
+
+        if (restart) continue;
+        if (curr != target) return; // target is no longer reachable
+        if (unlink(h, (prev) ? prev->next : _head, target, tnext)) return;
+    }
+}
+
+
+
 // ITERATOR STUFF
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::iterator_type
-concurrent_singly_linked_list<T, A>::begin()
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::iterator_type
+concurrent_singly_linked_list<T, A, R>::begin()
 {
     return iterator_type(_head.load(memo::acquire));
 }
 
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::const_iterator_type
-concurrent_singly_linked_list<T, A>::begin() const
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::const_iterator_type
+concurrent_singly_linked_list<T, A, R>::begin() const
 {
     return cbegin();
 }
 
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::const_iterator_type
-concurrent_singly_linked_list<T, A>::cbegin() const
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::const_iterator_type
+concurrent_singly_linked_list<T, A, R>::cbegin() const
 {
     return const_iterator_type(_head.load(memo::acquire));
 }
 
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::iterator_type
-concurrent_singly_linked_list<T, A>::end()
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::iterator_type
+concurrent_singly_linked_list<T, A, R>::end()
 {
     return iterator_type(nullptr);
 }
 
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::const_iterator_type
-concurrent_singly_linked_list<T, A>::end() const
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::const_iterator_type
+concurrent_singly_linked_list<T, A, R>::end() const
 {
     return cend();
 }
 
-template <class T, class A>
-typename concurrent_singly_linked_list<T, A>::const_iterator_type
-concurrent_singly_linked_list<T, A>::cend() const
+template <class T, class A, template <class> class R>
+typename concurrent_singly_linked_list<T, A, R>::const_iterator_type
+concurrent_singly_linked_list<T, A, R>::cend() const
 {
     return const_iterator_type(nullptr);
 }
@@ -294,44 +525,44 @@ concurrent_singly_linked_list<T, A>::cend() const
 
 
 // ITERATOR IMPLEMENTATION
-template <class T, class A>
+template <class T, class A, template <class> class R>
 template <bool c>
-typename concurrent_singly_linked_list<T,
-                                       A>::template iterator_base<c>::reference
-concurrent_singly_linked_list<T, A>::iterator_base<c>::operator*() const
+typename concurrent_singly_linked_list<T, A, R>::template iterator_base<
+    c>::reference
+concurrent_singly_linked_list<T, A, R>::iterator_base<c>::operator*() const
 {
     return _ptr->value;
 }
 
-template <class T, class A>
+template <class T, class A, template <class> class R>
 template <bool c>
-typename concurrent_singly_linked_list<T, A>::template iterator_base<c>::pointer
-concurrent_singly_linked_list<T, A>::iterator_base<c>::operator->() const
+typename concurrent_singly_linked_list<T, A, R>::template iterator_base<c>::pointer
+concurrent_singly_linked_list<T, A, R>::iterator_base<c>::operator->() const
 {
     return &(_ptr->value);
 }
 
-template <class T, class A>
+template <class T, class A, template <class> class R>
 template <bool c>
-typename concurrent_singly_linked_list<T, A>::template iterator_base<
+typename concurrent_singly_linked_list<T, A, R>::template iterator_base<
     c>::iterator_base&
-concurrent_singly_linked_list<T, A>::iterator_base<c>::operator++()
+concurrent_singly_linked_list<T, A, R>::iterator_base<c>::operator++()
 {
-    _ptr = _ptr->next.load(memo::acquire);
+    _ptr = mark::clear(_ptr->next.load(memo::acquire));
     return *this;
 }
 
-template <class T, class A>
+template <class T, class A, template <class> class R>
 template <bool c>
-bool concurrent_singly_linked_list<T, A>::iterator_base<c>::operator==(
+bool concurrent_singly_linked_list<T, A, R>::iterator_base<c>::operator==(
     const iterator_base& other) const
 {
     return _ptr == other._ptr;
 }
 
-template <class T, class A>
+template <class T, class A, template <class> class R>
 template <bool c>
-bool concurrent_singly_linked_list<T, A>::iterator_base<c>::operator!=(
+bool concurrent_singly_linked_list<T, A, R>::iterator_base<c>::operator!=(
     const iterator_base& other) const
 {
     return _ptr != other._ptr;
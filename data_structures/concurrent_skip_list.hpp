@@ -0,0 +1,588 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "../concurrency/memory_order.hpp"
+#include "../mark_pointer.hpp"
+#include "../memory_reclamation/hazard_reclamation.hpp"
+#include "../memory_reclamation/reclamation_guard.hpp"
+
+namespace utils_tm
+{
+
+namespace rtm = reclamation_tm;
+
+// Lock-free skip list (Herlihy, Lev, Luchangco, and Shavit; with the lock-free
+// unlinking of Fraser).  Each node stores its key and a tower of next
+// pointers, a node is logically deleted once the next pointer on its lowest
+// level is marked (higher levels are marked before that).  Traversals unlink
+// marked nodes on every level they pass, nodes are reclaimed through the
+// given reclamation manager, which is rebound to the node type.
+//
+// Keys are unique, and iterators traverse the lowest level in ascending order
+// (skipping logically deleted nodes).
+template <class Key,
+          class RecMngr    = reclamation_tm::hazard_manager<Key>,
+          class Compare    = std::less<Key>,
+          size_t MaxHeight = 24>
+class concurrent_skip_list
+{
+  private:
+    using this_type = concurrent_skip_list<Key, RecMngr, Compare, MaxHeight>;
+    using memo      = concurrency_tm::standard_memory_order_policy;
+
+    static_assert(MaxHeight > 0 && MaxHeight < 64,
+                  "the node height is generated from one 64bit random number");
+
+  public:
+    class node_type
+    {
+      public:
+        using atomic_node_ptr = std::atomic<node_type*>;
+
+        node_type(size_t h, Key k)
+            : key(std::move(k)), height(h), next(new atomic_node_ptr[h]),
+              finished(0)
+        {
+            for (size_t i = 0; i < h; ++i)
+                next[i].store(nullptr, memo::relaxed);
+        }
+        node_type(const node_type&)            = delete;
+        node_type& operator=(const node_type&) = delete;
+        ~node_type() { delete[] next; }
+
+        Key              key;
+        size_t           height;
+        atomic_node_ptr* next;
+        // inserter and eraser increment this once they stop (un)linking
+        // levels, the second one retires the node
+        std::atomic_int finished;
+    };
+
+    using key_type = Key;
+    using reclamation_manager_type =
+        typename RecMngr::template rebind<node_type>::other;
+    using reclamation_handle_type =
+        typename reclamation_manager_type::handle_type;
+    using node_ptr = typename reclamation_manager_type::pointer_type;
+    using atomic_node_ptr =
+        typename reclamation_manager_type::atomic_pointer_type;
+    using guard_type = typename reclamation_handle_type::guard_type;
+
+    static constexpr size_t max_height = MaxHeight;
+
+    template <bool is_const>
+    class iterator_base
+    {
+      private:
+        using this_type = iterator_base<is_const>;
+        using list_type = concurrent_skip_list;
+
+        list_type*               _list;
+        reclamation_handle_type* _handle;
+        guard_type               _guard;
+
+      public:
+        using difference_type = std::ptrdiff_t;
+        using value_type =
+            typename std::conditional<is_const, const Key, Key>::type;
+        using reference         = value_type&;
+        using pointer           = value_type*;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator_base(list_type*               list,
+                      reclamation_handle_type& h,
+                      guard_type               guard)
+            : _list(list), _handle(&h), _guard(std::move(guard))
+        {
+        }
+        iterator_base(iterator_base&& other)            = default;
+        iterator_base& operator=(iterator_base&& other) = default;
+        ~iterator_base()                                = default;
+
+        inline reference operator*() const;
+        inline pointer   operator->() const;
+
+        inline iterator_base& operator++();
+
+        inline bool operator==(const iterator_base& other) const;
+        inline bool operator!=(const iterator_base& other) const;
+    };
+
+    using iterator_type       = iterator_base<true>;
+    using const_iterator_type = iterator_base<true>;
+
+    concurrent_skip_list(Compare comp = {});
+    concurrent_skip_list(const concurrent_skip_list&)            = delete;
+    concurrent_skip_list& operator=(const concurrent_skip_list&) = delete;
+    ~concurrent_skip_list();
+
+    inline bool   insert(reclamation_handle_type& h, Key key);
+    inline size_t erase(reclamation_handle_type& h, const Key& key);
+    inline bool   contains(reclamation_handle_type& h, const Key& key);
+
+    iterator_type find(reclamation_handle_type& h, const Key& key);
+    // first key that is not smaller than key, together with end(h) this
+    // allows ordered range queries
+    iterator_type lower_bound(reclamation_handle_type& h, const Key& key);
+
+    // counts the unmarked nodes, not linearizable
+    size_t size(reclamation_handle_type& h);
+
+    inline iterator_type       begin(reclamation_handle_type& h);
+    inline const_iterator_type cbegin(reclamation_handle_type& h) const;
+    inline iterator_type       end(reclamation_handle_type& h);
+    inline const_iterator_type cend(reclamation_handle_type& h) const;
+
+  private:
+    // predecessors and successors of a key on each level
+    struct path_type
+    {
+        using guard_array = std::array<guard_type, MaxHeight>;
+
+        path_type(reclamation_handle_type& h)
+            : preds(empty_guards(h, std::make_index_sequence<MaxHeight>())),
+              succs(empty_guards(h, std::make_index_sequence<MaxHeight>()))
+        {
+        }
+        guard_array preds;
+        guard_array succs;
+
+        template <size_t... I>
+        static guard_array empty_guards(reclamation_handle_type& h,
+                                        std::index_sequence<I...>)
+        {
+            return {{((void)I, guard_type(h))...}};
+        }
+    };
+
+    [[no_unique_address]] Compare _comp;
+    atomic_node_ptr               _head[MaxHeight];
+
+    inline bool equal(const Key& a, const Key& b) const
+    {
+        return !_comp(a, b) && !_comp(b, a);
+    }
+    inline atomic_node_ptr& link(const guard_type& pred, size_t level)
+    {
+        return (pred) ? pred->next[level] : _head[level];
+    }
+    inline bool search(reclamation_handle_type& h,
+                       const Key&               key,
+                       guard_type&              curr,
+                       path_type*               path);
+    inline void link_levels(reclamation_handle_type& h,
+                            guard_type&              node,
+                            path_type&               path);
+    inline guard_type next_unmarked(reclamation_handle_type& h,
+                                    guard_type               curr);
+    inline guard_type skip_deleted(reclamation_handle_type& h,
+                                   guard_type               curr);
+    static inline guard_type copy_guard(reclamation_handle_type& h,
+                                        const guard_type&        guard);
+    static inline size_t     random_height();
+};
+
+
+
+template <class K, class R, class C, size_t mh>
+concurrent_skip_list<K, R, C, mh>::concurrent_skip_list(C comp)
+    : _comp(std::move(comp))
+{
+    for (auto& h : _head) h.store(nullptr, memo::relaxed);
+}
+
+// no concurrent operations allowed, the nodes were created by handles of a
+// reclamation manager, therefore, they are freed through a manager of the
+// same type (with its allocator)
+template <class K, class R, class C, size_t mh>
+concurrent_skip_list<K, R, C, mh>::~concurrent_skip_list()
+{
+    reclamation_manager_type manager;
+
+    auto temp = mark::clear(_head[0].exchange(nullptr, memo::relaxed));
+    while (temp)
+    {
+        auto next = mark::clear(temp->next[0].load(memo::relaxed));
+        manager.delete_raw(temp);
+        temp = next;
+    }
+}
+
+
+
+// finds the first node on the lowest level that is not smaller than key
+// (curr), returns true if it has the searched key.  If path is given, it is
+// filled with the predecessors and successors on all levels.  Marked nodes
+// on the way are unlinked.
+//
+// The protection of a successor is only valid, if the link it was loaded
+// from is still unchanged and unmarked afterwards (protect ignores marks,
+// and the successor of a marked node can be reclaimed), otherwise the
+// search restarts from the head.
+template <class K, class R, class C, size_t mh>
+bool concurrent_skip_list<K, R, C, mh>::search(reclamation_handle_type& h,
+                                               const K&                 key,
+                                               guard_type&              curr,
+                                               path_type*               path)
+{
+    while (true)
+    {
+        bool restart = false;
+        auto pred    = guard_type(h);
+
+        for (size_t level = mh; level-- > 0 && !restart;)
+        {
+            // pred might have been marked since we passed the level above
+            curr          = h.guard(link(pred, level));
+            node_ptr cptr = curr;
+            if (mark::is_marked(cptr) ||
+                link(pred, level).load(memo::acquire) != cptr)
+            {
+                restart = true;
+                break;
+            }
+
+            while (curr)
+            {
+                auto     succ = h.guard(curr->next[level]);
+                node_ptr sptr = succ;
+                if (curr->next[level].load(memo::acquire) != sptr)
+                {
+                    restart = true; // curr was changed (or marked)
+                    break;
+                }
+
+                // curr is deleted -> unlink it on this level
+                if (mark::is_marked(sptr))
+                {
+                    node_ptr temp = curr;
+                    if (!link(pred, level).compare_exchange_strong(
+                            temp, mark::clear(sptr), memo::acq_rel))
+                    {
+                        restart = true; // pred has changed
+                        break;
+                    }
+                    curr = std::move(succ);
+                    curr.unmark();
+                    continue;
+                }
+
+                if (!_comp(curr->key, key)) break;
+
+                pred = std::move(curr);
+                curr = std::move(succ);
+            }
+
+            if (path && !restart)
+            {
+                path->preds[level] = copy_guard(h, pred);
+                path->succs[level] = copy_guard(h, curr);
+            }
+        }
+
+        if (!restart) return curr && equal(curr->key, key);
+    }
+}
+
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::guard_type
+concurrent_skip_list<K, R, C, mh>::copy_guard(reclamation_handle_type& h,
+                                              const guard_type&        guard)
+{
+    if (!guard) return guard_type(h);
+    return rtm::add_guard(guard, node_ptr(guard));
+}
+
+// finds the first unmarked node behind curr (on the lowest level).  The
+// successor is only protected through an unmarked node, the next pointer of
+// a marked node might point to an already reclaimed node.  Therefore, once
+// curr is marked, the position is recomputed by searching its key (nodes
+// with the same key are skipped, the key was already visited).
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::guard_type
+concurrent_skip_list<K, R, C, mh>::next_unmarked(reclamation_handle_type& h,
+                                                 guard_type               curr)
+{
+    while (true)
+    {
+        auto     succ = guard_type(h);
+        node_ptr next = curr->next[0].load(memo::acquire);
+        if (mark::is_marked(next))
+        {
+            search(h, curr->key, succ, nullptr);
+            if (succ && !_comp(curr->key, succ->key))
+            {
+                curr = std::move(succ);
+                continue;
+            }
+        }
+        else
+        {
+            succ = rtm::add_guard(curr, curr->next[0]);
+            next = curr->next[0].load(memo::acquire);
+            if (next != node_ptr(succ) || mark::is_marked(next)) continue;
+        }
+
+        if (!succ || !mark::is_marked(succ->next[0].load(memo::acquire)))
+            return succ;
+        curr = std::move(succ);
+    }
+}
+
+// returns curr, or the first unmarked node behind it (if curr is marked)
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::guard_type
+concurrent_skip_list<K, R, C, mh>::skip_deleted(reclamation_handle_type& h,
+                                                guard_type               curr)
+{
+    curr.unmark();
+    if (curr && mark::is_marked(curr->next[0].load(memo::acquire)))
+        return next_unmarked(h, std::move(curr));
+    return curr;
+}
+
+// links an inserted node on its upper levels, stops early if the node is
+// erased concurrently
+template <class K, class R, class C, size_t mh>
+void concurrent_skip_list<K, R, C, mh>::link_levels(
+    reclamation_handle_type& h, guard_type& node, path_type& path)
+{
+    auto curr = guard_type(h);
+
+    for (size_t level = 1; level < node->height; ++level)
+    {
+        while (true)
+        {
+            // fails if the node was marked by a concurrent erase
+            node_ptr next = node->next[level].load(memo::acquire);
+            node_ptr succ = path.succs[level];
+            if (mark::is_marked(next)) return;
+            if (next != succ && !node->next[level].compare_exchange_strong(
+                                    next, succ, memo::acq_rel))
+                return;
+
+            node_ptr temp = succ;
+            if (link(path.preds[level], level)
+                    .compare_exchange_strong(temp, node, memo::acq_rel))
+                break;
+
+            // recompute the path, stop if the node was erased in the meantime
+            if (!search(h, node->key, curr, &path)) return;
+            if (node_ptr(curr) != node_ptr(node)) return;
+        }
+    }
+}
+
+// geometric distribution with p = 1/2
+template <class K, class R, class C, size_t mh>
+size_t concurrent_skip_list<K, R, C, mh>::random_height()
+{
+    // xorshift seeded with the address of the thread local state
+    thread_local size_t state = reinterpret_cast<size_t>(&state) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return std::countr_zero(state | (size_t(1) << (mh - 1))) + 1;
+}
+
+
+
+// the node is linked bottom up, it is inserted once it is linked on the
+// lowest level, higher levels are only shortcuts
+template <class K, class R, class C, size_t mh>
+bool concurrent_skip_list<K, R, C, mh>::insert(reclamation_handle_type& h,
+                                               K                        key)
+{
+    auto path   = path_type(h);
+    auto curr   = guard_type(h);
+    auto height = random_height();
+    auto node =
+        rtm::make_rec_guard(h, h.create_pointer(height, std::move(key)));
+
+    while (true)
+    {
+        if (search(h, node->key, curr, &path))
+        {
+            h.delete_raw(node.release());
+            return false;
+        }
+
+        for (size_t level = 0; level < height; ++level)
+            node->next[level].store(path.succs[level], memo::relaxed);
+
+        node_ptr temp = path.succs[0];
+        if (link(path.preds[0], 0)
+                .compare_exchange_strong(temp, node, memo::acq_rel))
+            break;
+    }
+
+    link_levels(h, node, path);
+
+    // a concurrent erase finished first, its search might have missed the
+    // levels we linked last
+    if (node->finished.fetch_add(1, memo::acq_rel) == 1)
+    {
+        search(h, node->key, curr, nullptr);
+        h.safe_delete(node);
+    }
+    return true;
+}
+
+// the node is marked top down, it is erased once its lowest level is marked
+template <class K, class R, class C, size_t mh>
+size_t concurrent_skip_list<K, R, C, mh>::erase(reclamation_handle_type& h,
+                                                const K&                 key)
+{
+    auto path = path_type(h);
+    auto curr = guard_type(h);
+    if (!search(h, key, curr, &path)) return 0;
+
+    for (size_t level = curr->height - 1; level > 0; --level)
+    {
+        node_ptr next = curr->next[level].load(memo::acquire);
+        while (!mark::is_marked(next) &&
+               !mark::atomic_mark<0>(curr->next[level], next, memo::acq_rel))
+        { /* retry with the updated next */
+        }
+    }
+
+    node_ptr next = curr->next[0].load(memo::acquire);
+    while (true)
+    {
+        if (mark::is_marked(next)) return 0; // erased concurrently
+        if (mark::atomic_mark<0>(curr->next[0], next, memo::acq_rel)) break;
+    }
+
+    // unlink the node on all levels, then it can be reclaimed (unless the
+    // inserter is still linking levels, then it retires the node)
+    auto node = std::move(curr);
+    search(h, key, curr, nullptr);
+    if (node->finished.fetch_add(1, memo::acq_rel) == 1) h.safe_delete(node);
+    return 1;
+}
+
+template <class K, class R, class C, size_t mh>
+bool concurrent_skip_list<K, R, C, mh>::contains(reclamation_handle_type& h,
+                                                 const K&                 key)
+{
+    auto curr = guard_type(h);
+    return search(h, key, curr, nullptr);
+}
+
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::iterator_type
+concurrent_skip_list<K, R, C, mh>::find(reclamation_handle_type& h,
+                                        const K&                 key)
+{
+    auto curr = guard_type(h);
+    if (!search(h, key, curr, nullptr)) return end(h);
+    return iterator_type(this, h, std::move(curr));
+}
+
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::iterator_type
+concurrent_skip_list<K, R, C, mh>::lower_bound(reclamation_handle_type& h,
+                                               const K&                 key)
+{
+    auto curr = guard_type(h);
+    search(h, key, curr, nullptr);
+    return iterator_type(this, h, skip_deleted(h, std::move(curr)));
+}
+
+template <class K, class R, class C, size_t mh>
+size_t concurrent_skip_list<K, R, C, mh>::size(reclamation_handle_type& h)
+{
+    size_t result = 0;
+    for (auto it = begin(h); it != end(h); ++it) { ++result; }
+    return result;
+}
+
+
+
+// ITERATOR STUFF
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::iterator_type
+concurrent_skip_list<K, R, C, mh>::begin(reclamation_handle_type& h)
+{
+    return iterator_type(this, h, skip_deleted(h, h.guard(_head[0])));
+}
+
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::const_iterator_type
+concurrent_skip_list<K, R, C, mh>::cbegin(reclamation_handle_type& h) const
+{
+    auto list = const_cast<concurrent_skip_list*>(this);
+    auto curr = list->skip_deleted(h, h.guard(_head[0]));
+    return const_iterator_type(list, h, std::move(curr));
+}
+
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::iterator_type
+concurrent_skip_list<K, R, C, mh>::end(reclamation_handle_type& h)
+{
+    return iterator_type(this, h, guard_type(h));
+}
+
+template <class K, class R, class C, size_t mh>
+typename concurrent_skip_list<K, R, C, mh>::const_iterator_type
+concurrent_skip_list<K, R, C, mh>::cend(reclamation_handle_type& h) const
+{
+    auto list = const_cast<concurrent_skip_list*>(this);
+    return const_iterator_type(list, h, guard_type(h));
+}
+
+
+
+// ITERATOR IMPLEMENTATION
+template <class K, class R, class C, size_t mh>
+template <bool c>
+typename concurrent_skip_list<K, R, C, mh>::template iterator_base<c>::reference
+concurrent_skip_list<K, R, C, mh>::iterator_base<c>::operator*() const
+{
+    return _guard->key;
+}
+
+template <class K, class R, class C, size_t mh>
+template <bool c>
+typename concurrent_skip_list<K, R, C, mh>::template iterator_base<c>::pointer
+concurrent_skip_list<K, R, C, mh>::iterator_base<c>::operator->() const
+{
+    return &(_guard->key);
+}
+
+// skips all logically deleted nodes
+template <class K, class R, class C, size_t mh>
+template <bool c>
+typename concurrent_skip_list<K, R, C, mh>::template iterator_base<
+    c>::iterator_base&
+concurrent_skip_list<K, R, C, mh>::iterator_base<c>::operator++()
+{
+    guard_type tguard = _list->next_unmarked(*_handle, std::move(_guard));
+    _guard            = std::move(tguard);
+    return *this;
+}
+
+template <class K, class R, class C, size_t mh>
+template <bool c>
+bool concurrent_skip_list<K, R, C, mh>::iterator_base<c>::operator==(
+    const iterator_base& other) const
+{
+    return node_ptr(_guard) == node_ptr(other._guard);
+}
+
+template <class K, class R, class C, size_t mh>
+template <bool c>
+bool concurrent_skip_list<K, R, C, mh>::iterator_base<c>::operator!=(
+    const iterator_base& other) const
+{
+    return node_ptr(_guard) != node_ptr(other._guard);
+}
+
+} // namespace utils_tm
@@ -3,58 +3,252 @@
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <optional>
+#include <type_traits>
 
 #include "../concurrency/memory_order.hpp"
+#include "../debug.hpp"
 
 namespace utils_tm
 {
 
+// SLOT TYPES *** (the buffer can use either of them) **************************
+// Each slot type offers store (producer side), and wait/take/reset (consumer
+// side).  Resetting a slot makes it ready to be written again.
+
+// empty slots contain the dummy element, the element is stored in one atomic
+// (only usable if the element type can be used as template parameter, and
+// std::atomic<T> is lock-free).  The dummy value itself can never be stored,
+// the consumer would wait for it forever (checked in debug mode).
+template <class T, T dummy>
+class mpsc_dummy_slot
+{
+  private:
+    using memo = concurrency_tm::standard_memory_order_policy;
+
+  public:
+    using reference = T;
+
+    mpsc_dummy_slot() : _value(dummy) {}
+    mpsc_dummy_slot(const mpsc_dummy_slot& other)
+        : _value(other._value.load(memo::relaxed))
+    {
+    }
+    mpsc_dummy_slot& operator=(const mpsc_dummy_slot&) = delete;
+
+    inline void store(const T& e)
+    {
+        debug_tm::if_debug_critical(
+            "mpsc_dummy_slot: the dummy element cannot be stored", e == dummy);
+        _value.store(e, memo::release);
+    }
+    inline bool is_ready() const
+    {
+        return !(_value.load(memo::acquire) == dummy);
+    }
+    inline reference wait()
+    {
+        auto read = _value.load(memo::acquire);
+        while (read == dummy) read = _value.load(memo::acquire);
+        return read;
+    }
+    inline T take()
+    {
+        auto read = wait();
+        reset();
+        return read;
+    }
+    inline void reset() { _value.store(dummy, memo::relaxed); }
+
+  private:
+    std::atomic<T> _value;
+};
+
+// each slot has a ready flag next to the (uninitialized) element storage,
+// the element is constructed by the producer, and destroyed on reset
+template <class T>
+class mpsc_flagged_slot
+{
+  private:
+    using memo = concurrency_tm::standard_memory_order_policy;
+
+  public:
+    using reference = T&;
+
+    mpsc_flagged_slot() : _ready(false) {}
+    mpsc_flagged_slot(const mpsc_flagged_slot& other)
+        : _ready(other._ready.load(memo::relaxed))
+    {
+        if (_ready.load(memo::relaxed)) new (&_value) T(other._value);
+    }
+    mpsc_flagged_slot& operator=(const mpsc_flagged_slot&) = delete;
+    ~mpsc_flagged_slot()
+    {
+        if (_ready.load(memo::relaxed)) _value.~T();
+    }
+
+    inline void store(const T& e)
+    {
+        new (&_value) T(e);
+        _ready.store(true, memo::release);
+    }
+    inline bool is_ready() const { return _ready.load(memo::acquire); }
+    inline reference wait()
+    {
+        while (!_ready.load(memo::acquire))
+        { /* wait for the producer */
+        }
+        return _value;
+    }
+    inline T take()
+    {
+        auto read = std::move(wait());
+        reset();
+        return read;
+    }
+    inline void reset()
+    {
+        _value.~T();
+        _ready.store(false, memo::relaxed);
+    }
+
+  private:
+    std::atomic_bool _ready;
+    union
+    {
+        T _value;
+    };
+};
+
+
+
+
 // This structure is owned by one thread, and is meant to pass inputs
 // to that thread
-template <class T, class Allocator = std::allocator<T>, T dummy = T()>
-class many_producer_single_consumer_buffer
+//
+// The buffer consists of two halves, producers write into one half while the
+// consumer reads from the other.  Whenever the consumer has drained its half,
+// the halves are swapped.  If the buffer was constructed with a max_capacity
+// larger than its capacity, the consumer grows the halves at the swap point
+// once it observes that producers have overflown their half.
+//
+// Usually, this is used through one of the aliases below
+// (many_producer_single_consumer_buffer, flagged_..., or auto_...).
+template <class T, class Slot, class Allocator = std::allocator<T>>
+class basic_many_producer_single_consumer_buffer
 {
   public:
-    using this_type  = many_producer_single_consumer_buffer<T, Allocator>;
+    using this_type =
+        basic_many_producer_single_consumer_buffer<T, Slot, Allocator>;
     using memo       = concurrency_tm::standard_memory_order_policy;
-    using value_type = std::atomic<T>;
+    using slot_type  = Slot;
+    using value_type = T;
     using allocator_type =
-        typename std::allocator_traits<Allocator>::rebind_alloc<std::atomic<T>>;
+        typename std::allocator_traits<Allocator>::rebind_alloc<slot_type>;
     using alloc_traits = std::allocator_traits<allocator_type>;
 
   private:
-    static constexpr T                   _dummy            = dummy;
+    // Positions handed out to producers are not reset when the halves are
+    // swapped, instead each half stores the position of its first slot
+    // (base).  Thus, a slow producer that overflowed a half can never end up
+    // with a valid slot once the half has been reset or grown.
+    // The consumer writes base before capacity (release), producers read
+    // capacity (acquire) before base.
+    struct half_type
+    {
+        std::atomic<slot_type*> buffer;
+        std::atomic_size_t      base;
+        std::atomic_size_t      capacity;
+    };
+
     static constexpr size_t              _scnd_buffer_flag = 1ull << 63;
     [[no_unique_address]] allocator_type _allocator;
     size_t                               _capacity;
+    size_t                               _max_capacity;
     std::atomic_size_t                   _pos;
-    size_t                               _read_pos;
-    size_t                               _read_end;
-    std::atomic<T>*                      _buffer;
+    half_type                            _halves[2];
+
+    // consumer state
+    // slots in [_reset_pos, _read_pos) have been pulled but not yet reset
+    size_t     _read_half;
+    size_t     _read_pos;
+    size_t     _read_end;
+    size_t     _reset_pos;
+    size_t     _next_base;
+    slot_type* _read_buffer;
 
   public:
-    explicit many_producer_single_consumer_buffer(size_t         capacity,
-                                                  allocator_type alloc = {});
-    explicit many_producer_single_consumer_buffer(
+    // iterates over a pulled range, dereferencing waits until the producer
+    // has finished writing the slot
+    class wait_iterator
+    {
+      private:
+        slot_type* _ptr;
+
+      public:
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = T;
+        using reference         = typename slot_type::reference;
+        using pointer           = T*;
+        using iterator_category = std::forward_iterator_tag;
+
+        wait_iterator(slot_type* ptr) : _ptr(ptr) {}
+        wait_iterator(const wait_iterator& other)            = default;
+        wait_iterator& operator=(const wait_iterator& other) = default;
+        ~wait_iterator()                                     = default;
+
+        inline reference      operator*() const;
+        inline wait_iterator& operator++();
+
+        inline bool operator==(const wait_iterator& other) const;
+        inline bool operator!=(const wait_iterator& other) const;
+    };
+
+    class pulled_range
+    {
+      private:
+        wait_iterator _begin;
+        wait_iterator _end;
+        size_t        _size;
+
+      public:
+        pulled_range(slot_type* begin, slot_type* end)
+            : _begin(begin), _end(end), _size(end - begin)
+        {
+        }
+
+        wait_iterator begin() const { return _begin; }
+        wait_iterator end() const { return _end; }
+        size_t        size() const { return _size; }
+        bool          empty() const { return _size == 0; }
+    };
+
+    explicit basic_many_producer_single_consumer_buffer(
+        size_t capacity, allocator_type alloc = {});
+    basic_many_producer_single_consumer_buffer(size_t         capacity,
+                                               size_t         max_capacity,
+                                               allocator_type alloc = {});
+    explicit basic_many_producer_single_consumer_buffer(
         allocator_type alloc = {}) noexcept;
 
-    many_producer_single_consumer_buffer(
-        const many_producer_single_consumer_buffer& other,
-        allocator_type                              alloc = {});
-    many_producer_single_consumer_buffer&
-    operator=(const many_producer_single_consumer_buffer&);
+    basic_many_producer_single_consumer_buffer(
+        const basic_many_producer_single_consumer_buffer& other,
+        allocator_type                                    alloc = {});
+    basic_many_producer_single_consumer_buffer&
+    operator=(const basic_many_producer_single_consumer_buffer&);
 
-    many_producer_single_consumer_buffer(
-        many_producer_single_consumer_buffer&& other) noexcept;
-    many_producer_single_consumer_buffer(
-        many_producer_single_consumer_buffer&& other,
-        allocator_type                         alloc) noexcept;
-    many_producer_single_consumer_buffer&
-    operator=(many_producer_single_consumer_buffer&& rhs) noexcept;
+    basic_many_producer_single_consumer_buffer(
+        basic_many_producer_single_consumer_buffer&& other) noexcept;
+    basic_many_producer_single_consumer_buffer(
+        basic_many_producer_single_consumer_buffer&& other,
+        allocator_type                               alloc) noexcept;
+    basic_many_producer_single_consumer_buffer&
+    operator=(basic_many_producer_single_consumer_buffer&& rhs) noexcept;
 
-    ~many_producer_single_consumer_buffer();
+    ~basic_many_producer_single_consumer_buffer();
 
 
     // can be called concurrently by all kinds of threads
@@ -69,111 +263,187 @@ class many_producer_single_consumer_buffer
     // can be called concurrent to push_backs but only by the owning thread
     // pull_all breaks all previously pulled elements
     std::optional<T> pop();
-
+    // returns all remaining elements of the read half (swaps halves if the
+    // read half is empty), the pulled slots are only reset once the next
+    // swap happens, therefore, the range stays valid until the next call to
+    // pop or pull_all
+    pulled_range pull_all();
+
+    // capacity of each half (the capacity of the write half might lag behind
+    // until the next swap)
+    size_t         capacity() const { return _capacity; }
+    size_t         max_capacity() const { return _max_capacity; }
     allocator_type get_allocator() const { return _allocator; }
 
   private:
+    void init_half(half_type& half, size_t capacity, size_t base);
+    void copy_half(half_type& half, const half_type& other);
+    void destroy_half(half_type& half);
+    void grow_half(half_type& half, size_t capacity, size_t base);
+
+    inline slot_type* claim(size_t tpos, size_t& number) const;
+
+    void reset_pulled();
     void fetch_on_empty_read_buffer();
 };
 
 
 
+// ALIASES AND AUTOMATIC CHOOSER ***********************************************
+// the dummy element (T() by default) can not be pushed into this buffer
+template <class T, class Allocator = std::allocator<T>, T dummy = T()>
+using many_producer_single_consumer_buffer =
+    basic_many_producer_single_consumer_buffer<T,
+                                               mpsc_dummy_slot<T, dummy>,
+                                               Allocator>;
+
+template <class T, class Allocator = std::allocator<T>>
+using flagged_many_producer_single_consumer_buffer =
+    basic_many_producer_single_consumer_buffer<T,
+                                               mpsc_flagged_slot<T>,
+                                               Allocator>;
+
+// true if T can be stored in dummy slots, i.e. T is a pointer (nullptr is the
+// dummy) and std::atomic<T> is lock-free.  Other types (e.g. int, size_t,
+// enums) use flagged slots, since T() is a valid element for them.
+template <class T>
+constexpr bool mpsc_use_dummy_slot()
+{
+    if constexpr (!std::is_pointer_v<T>) return false;
+    else
+        return std::atomic<T>::is_always_lock_free;
+}
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>::
-    many_producer_single_consumer_buffer(size_t capacity, allocator_type alloc)
-    : _allocator(alloc), _capacity(capacity), _pos(0), _read_pos(0),
-      _read_end(0)
+template <class T, class Allocator, bool use_dummy = mpsc_use_dummy_slot<T>()>
+struct mpsc_buffer_chooser
 {
-    _buffer = alloc_traits::allocate(_allocator, 2 * capacity);
+    using type = many_producer_single_consumer_buffer<T, Allocator>;
+};
 
-    for (auto ptr = _buffer; ptr < _buffer + (2 * capacity); ++ptr)
-    {
-        alloc_traits::construct(_allocator, ptr, _dummy);
-    }
+template <class T, class Allocator>
+struct mpsc_buffer_chooser<T, Allocator, false>
+{
+    using type = flagged_many_producer_single_consumer_buffer<T, Allocator>;
+};
+
+template <class T, class Allocator = std::allocator<T>>
+using auto_many_producer_single_consumer_buffer =
+    typename mpsc_buffer_chooser<T, Allocator>::type;
+
+
+
+
+// CTORS AND DTOR **************************************************************
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    basic_many_producer_single_consumer_buffer(size_t         capacity,
+                                               allocator_type alloc)
+    : basic_many_producer_single_consumer_buffer(capacity, capacity, alloc)
+{
 }
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>::
-    many_producer_single_consumer_buffer(allocator_type alloc) noexcept
-    : _allocator(alloc), _pos(0), _read_pos(0), _read_end(0)
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    basic_many_producer_single_consumer_buffer(size_t         capacity,
+                                               size_t         max_capacity,
+                                               allocator_type alloc)
+    : _allocator(alloc), _capacity(capacity),
+      _max_capacity(std::max(capacity, max_capacity)), _pos(0), _read_half(1),
+      _read_pos(0), _read_end(0), _reset_pos(0), _next_base(0),
+      _read_buffer(nullptr)
+{
+    init_half(_halves[0], capacity, 0);
+    init_half(_halves[1], capacity, 0);
+}
+
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    basic_many_producer_single_consumer_buffer(allocator_type alloc) noexcept
+    : _allocator(alloc), _pos(0), _read_half(1), _read_pos(0), _read_end(0),
+      _reset_pos(0), _next_base(0), _read_buffer(nullptr)
 {
     constexpr size_t default_capacity = 64;
     _capacity                         = default_capacity;
+    _max_capacity                     = default_capacity;
 
-    _buffer = alloc_traits::allocate(_allocator, 2 * default_capacity);
-    for (auto ptr = _buffer; ptr < _buffer + (2 * default_capacity); ++ptr)
-    {
-        alloc_traits::construct(_allocator, ptr, _dummy);
-    }
+    init_half(_halves[0], default_capacity, 0);
+    init_half(_halves[1], default_capacity, 0);
 }
 
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>::
-    many_producer_single_consumer_buffer(
-        const many_producer_single_consumer_buffer& other, allocator_type alloc)
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    basic_many_producer_single_consumer_buffer(
+        const basic_many_producer_single_consumer_buffer& other,
+        allocator_type                                    alloc)
     : _allocator(alloc), _capacity(other._capacity),
-      _pos(other._pos.load(memo::relaxed)), _read_pos(other._read_pos),
-      _read_end(other._read_end)
+      _max_capacity(other._max_capacity), _pos(other._pos.load(memo::relaxed)),
+      _read_half(other._read_half), _read_pos(other._read_pos),
+      _read_end(other._read_end), _reset_pos(other._reset_pos),
+      _next_base(other._next_base)
 {
-    _buffer = alloc_traits::allocate(_allocator, 2 * _capacity);
-
-    for (size_t i = 0; i < 2 * _capacity; ++i)
-    {
-        alloc_traits::construct(_allocator, _buffer + i,
-                                other._buffer[i].load(memo::relaxed));
-    }
+    copy_half(_halves[0], other._halves[0]);
+    copy_half(_halves[1], other._halves[1]);
+    _read_buffer = _halves[_read_half].buffer.load(memo::relaxed);
 }
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>&
-many_producer_single_consumer_buffer<T, A, d>::operator=(
-    const many_producer_single_consumer_buffer& rhs)
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>&
+basic_many_producer_single_consumer_buffer<T, S, A>::operator=(
+    const basic_many_producer_single_consumer_buffer& rhs)
 {
     if (&rhs == this) return *this;
 
     this->~this_type();
-    new (this) many_producer_single_consumer_buffer(rhs, rhs.get_allocator());
+    new (this)
+        basic_many_producer_single_consumer_buffer(rhs, rhs.get_allocator());
     return *this;
 }
 
 
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>::
-    many_producer_single_consumer_buffer(
-        many_producer_single_consumer_buffer&& other) noexcept
-    : _allocator(other._allocator), _capacity(other._capacity),
-      _pos(other._pos.load(memo::relaxed)), _read_pos(other._read_pos),
-      _read_end(other._read_end)
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    basic_many_producer_single_consumer_buffer(
+        basic_many_producer_single_consumer_buffer&& other) noexcept
+    : basic_many_producer_single_consumer_buffer(std::move(other),
+                                                 other._allocator)
 {
-    _buffer       = other._buffer;
-    other._buffer = nullptr;
 }
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>::
-    many_producer_single_consumer_buffer(
-        many_producer_single_consumer_buffer&& other,
-        allocator_type                         alloc) noexcept
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    basic_many_producer_single_consumer_buffer(
+        basic_many_producer_single_consumer_buffer&& other,
+        allocator_type                               alloc) noexcept
     : _allocator(alloc), _capacity(other._capacity),
-      _pos(other._pos.load(memo::relaxed)), _read_pos(other._read_pos),
-      _read_end(other._read_end)
+      _max_capacity(other._max_capacity), _pos(other._pos.load(memo::relaxed)),
+      _read_half(other._read_half), _read_pos(other._read_pos),
+      _read_end(other._read_end), _reset_pos(other._reset_pos),
+      _next_base(other._next_base), _read_buffer(other._read_buffer)
 {
-    _buffer       = other._buffer;
-    other._buffer = nullptr;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        auto& half  = _halves[i];
+        auto& ohalf = other._halves[i];
+        half.buffer.store(ohalf.buffer.exchange(nullptr, memo::relaxed),
+                          memo::relaxed);
+        half.base.store(ohalf.base.load(memo::relaxed), memo::relaxed);
+        half.capacity.store(ohalf.capacity.exchange(0, memo::relaxed),
+                            memo::relaxed);
+    }
+    other._read_buffer = nullptr;
 }
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>&
-many_producer_single_consumer_buffer<T, A, d>::operator=(
-    many_producer_single_consumer_buffer&& rhs) noexcept
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>&
+basic_many_producer_single_consumer_buffer<T, S, A>::operator=(
+    basic_many_producer_single_consumer_buffer&& rhs) noexcept
 {
     if (&rhs == this) return *this;
 
     this->~this_type();
-    new (this) many_producer_single_consumer_buffer(std::move(rhs));
+    new (this) basic_many_producer_single_consumer_buffer(std::move(rhs));
     return *this;
 }
 
@@ -181,106 +451,251 @@ many_producer_single_consumer_buffer<T, A, d>::operator=(
 
 
 
-template <class T, class A, T d>
-many_producer_single_consumer_buffer<T, A, d>::
-    ~many_producer_single_consumer_buffer()
+template <class T, class S, class A>
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    ~basic_many_producer_single_consumer_buffer()
 {
-    // delete[] _buffer;
-    if (!_buffer) return;
-    for (auto ptr = _buffer; ptr < _buffer + (2 * _capacity); ++ptr)
-    {
-        alloc_traits::destroy(_allocator, ptr);
-    }
-    alloc_traits::deallocate(_allocator, _buffer, 2 * _capacity);
+    destroy_half(_halves[0]);
+    destroy_half(_halves[1]);
 }
 
 
 
 
-
-template <class T, class A, T d>
+// MAIN FUNCTIONALITY **********************************************************
+template <class T, class S, class A>
 bool //
-many_producer_single_consumer_buffer<T, A, d>::push_back(const T& e)
+basic_many_producer_single_consumer_buffer<T, S, A>::push_back(const T& e)
 {
-    auto tpos = _pos.fetch_add(1, memo::acq_rel);
-
-    if (tpos & _scnd_buffer_flag)
-    {
-        tpos ^= _scnd_buffer_flag;
-        if (tpos >= _capacity * 2) return false;
-    }
-    else if (tpos >= _capacity)
-        return false;
+    auto   tpos   = _pos.fetch_add(1, memo::acq_rel);
+    size_t number = 1;
+    auto   slot   = claim(tpos, number);
+    if (!number) return false;
 
-    _buffer[tpos].store(e, memo::relaxed);
+    slot->store(e);
     return true;
 }
 
-template <class T, class A, T d>
+template <class T, class S, class A>
 template <class iterator_type>
 size_t //
-many_producer_single_consumer_buffer<T, A, d>::push_back(
+basic_many_producer_single_consumer_buffer<T, S, A>::push_back(
     iterator_type& start, const iterator_type& end, size_t number)
 {
     if (number == 0) number = end - start;
 
-    size_t tpos   = _pos.fetch_add(number, memo::acq_rel);
-    size_t endpos = 0;
-    if (tpos & _scnd_buffer_flag)
-    {
-        tpos ^= _scnd_buffer_flag;
-        endpos = std::min(tpos + number, _capacity * 2);
-    }
-    else
-        endpos = std::min(tpos + number, _capacity);
+    auto tpos = _pos.fetch_add(number, memo::acq_rel);
+    auto slot = claim(tpos, number);
 
-    number = endpos - tpos;
-
-    for (; tpos < endpos; ++tpos)
+    for (auto slot_end = slot + number; slot < slot_end; ++slot)
     {
-        _buffer[tpos]->store(*start, memo::release);
+        slot->store(*start);
         start++;
     }
     return number;
 }
 
-template <class T, class A, T d>
+template <class T, class S, class A>
 std::optional<T> //
-many_producer_single_consumer_buffer<T, A, d>::pop()
+basic_many_producer_single_consumer_buffer<T, S, A>::pop()
 {
     if (_read_pos == _read_end)
     {
         fetch_on_empty_read_buffer();
         if (_read_pos == _read_end) return {};
     }
-    auto read = _buffer[_read_pos].load(memo::relaxed);
-    while (read == _dummy) read = _buffer[_read_pos].load(memo::relaxed);
-    _buffer[_read_pos].store(_dummy, memo::relaxed);
-    ++_read_pos;
-    return std::make_optional(read);
+    auto result = std::make_optional(_read_buffer[_read_pos].take());
+    _reset_pos  = ++_read_pos;
+    return result;
 }
 
+template <class T, class S, class A>
+typename basic_many_producer_single_consumer_buffer<T, S, A>::pulled_range //
+basic_many_producer_single_consumer_buffer<T, S, A>::pull_all()
+{
+    if (_read_pos == _read_end) fetch_on_empty_read_buffer();
 
-template <class T, class A, T d>
+    auto result =
+        pulled_range(_read_buffer + _read_pos, _read_buffer + _read_end);
+    _read_pos = _read_end;
+    return result;
+}
+
+
+
+
+// HELPER FUNCTIONS ************************************************************
+template <class T, class S, class A>
 void //
-many_producer_single_consumer_buffer<T, A, d>::fetch_on_empty_read_buffer()
+basic_many_producer_single_consumer_buffer<T, S, A>::init_half(half_type& half,
+                                                               size_t capacity,
+                                                               size_t base)
 {
-    bool first_to_second = !(_scnd_buffer_flag & _pos.load(memo::relaxed));
-    if (first_to_second)
+    auto buffer = alloc_traits::allocate(_allocator, capacity);
+    for (auto ptr = buffer; ptr < buffer + capacity; ++ptr)
     {
-        _read_end = _pos.exchange(_capacity | _scnd_buffer_flag, memo::acq_rel);
-        _read_end = std::min(_read_end, _capacity);
-        _read_pos = 0;
+        alloc_traits::construct(_allocator, ptr);
     }
-    else
+    half.buffer.store(buffer, memo::relaxed);
+    half.base.store(base, memo::relaxed);
+    half.capacity.store(capacity, memo::release);
+}
+
+template <class T, class S, class A>
+void //
+basic_many_producer_single_consumer_buffer<T, S, A>::copy_half(
+    half_type& half, const half_type& other)
+{
+    auto capacity = other.capacity.load(memo::relaxed);
+    auto obuffer  = other.buffer.load(memo::relaxed);
+    auto buffer   = alloc_traits::allocate(_allocator, capacity);
+    for (size_t i = 0; i < capacity; ++i)
     {
-        _read_end = _pos.exchange(0, memo::acq_rel);
-        _read_end ^= _scnd_buffer_flag;
-        _read_end = std::min(_read_end, 2 * _capacity);
-        _read_pos = _capacity;
+        alloc_traits::construct(_allocator, buffer + i, obuffer[i]);
     }
+    half.buffer.store(buffer, memo::relaxed);
+    half.base.store(other.base.load(memo::relaxed), memo::relaxed);
+    half.capacity.store(capacity, memo::relaxed);
 }
 
+template <class T, class S, class A>
+void //
+basic_many_producer_single_consumer_buffer<T, S, A>::destroy_half(
+    half_type& half)
+{
+    auto buffer   = half.buffer.load(memo::relaxed);
+    auto capacity = half.capacity.load(memo::relaxed);
+    if (!buffer) return;
+    for (auto ptr = buffer; ptr < buffer + capacity; ++ptr)
+    {
+        alloc_traits::destroy(_allocator, ptr);
+    }
+    alloc_traits::deallocate(_allocator, buffer, capacity);
+}
 
+// only called by the consumer on a drained half, that is not visible to the
+// producers (valid writes to this half are finished, because the consumer
+// waited for them)
+template <class T, class S, class A>
+void //
+basic_many_producer_single_consumer_buffer<T, S, A>::grow_half(half_type& half,
+                                                               size_t capacity,
+                                                               size_t base)
+{
+    if (half.capacity.load(memo::relaxed) >= capacity)
+    {
+        half.base.store(base, memo::release);
+        return;
+    }
+    destroy_half(half);
+    init_half(half, capacity, base);
+}
+
+// translates a position (fetched from _pos) into a slot, number is reduced to
+// the number of slots available to the caller
+template <class T, class S, class A>
+typename basic_many_producer_single_consumer_buffer<T, S, A>::slot_type* //
+basic_many_producer_single_consumer_buffer<T, S, A>::claim(
+    size_t tpos, size_t& number) const
+{
+    const auto& half = _halves[(tpos & _scnd_buffer_flag) ? 1 : 0];
+    tpos &= ~_scnd_buffer_flag;
+
+    auto capacity = half.capacity.load(memo::acquire);
+    auto offset   = tpos - half.base.load(memo::acquire);
+    if (offset >= capacity)
+    {
+        number = 0;
+        return nullptr;
+    }
+    number = std::min(number, capacity - offset);
+    return half.buffer.load(memo::relaxed) + offset;
+}
+
+// resets all pulled slots at once, slots can only be reset, once the producer
+// has written them (otherwise the write could happen after the reset)
+template <class T, class S, class A>
+void //
+basic_many_producer_single_consumer_buffer<T, S, A>::reset_pulled()
+{
+    for (auto i = _reset_pos; i < _read_end; ++i)
+    {
+        _read_buffer[i].wait();
+        _read_buffer[i].reset();
+    }
+    _reset_pos = _read_end;
+}
+
+template <class T, class S, class A>
+void //
+basic_many_producer_single_consumer_buffer<T, S, A>::
+    fetch_on_empty_read_buffer()
+{
+    reset_pulled();
+
+    auto  write_half = 1 - _read_half;
+    auto& whalf      = _halves[write_half];
+    auto& rhalf      = _halves[_read_half];
+    auto  wflag      = (write_half) ? _scnd_buffer_flag : 0;
+    auto  rflag      = (_read_half) ? _scnd_buffer_flag : 0;
+    auto  wbase      = whalf.base.load(memo::relaxed);
+    auto  wcapacity  = whalf.capacity.load(memo::relaxed);
+
+    // producers have overflown the current write half -> grow both halves
+    // (the read half now, the write half once it is drained)
+    auto overflown = [&](size_t pos) { return pos - wbase > wcapacity; };
+    if (_capacity < _max_capacity &&
+        overflown(_pos.load(memo::relaxed) ^ wflag))
+    {
+        _capacity =
+            std::min(std::max(2 * _capacity, size_t(64)), _max_capacity);
+    }
+
+    // the drained read half becomes the new write half
+    grow_half(rhalf, _capacity, _next_base);
+
+    auto end = _pos.exchange(rflag | _next_base, memo::acq_rel) ^ wflag;
+
+    _read_half   = write_half;
+    _read_buffer = whalf.buffer.load(memo::relaxed);
+    _read_pos    = 0;
+    _reset_pos   = 0;
+    _read_end    = std::min(end - wbase, wcapacity);
+    _next_base   = end;
+}
+
+
+
+// WAIT ITERATOR IMPLEMENTATION ************************************************
+template <class T, class S, class A>
+typename basic_many_producer_single_consumer_buffer<T, S, A>::wait_iterator::
+    reference
+    basic_many_producer_single_consumer_buffer<T, S, A>::wait_iterator::
+    operator*() const
+{
+    return _ptr->wait();
+}
+
+template <class T, class S, class A>
+typename basic_many_producer_single_consumer_buffer<T, S, A>::wait_iterator&
+basic_many_producer_single_consumer_buffer<T, S, A>::wait_iterator::operator++()
+{
+    ++_ptr;
+    return *this;
+}
+
+template <class T, class S, class A>
+bool basic_many_producer_single_consumer_buffer<T, S, A>::wait_iterator::
+operator==(const wait_iterator& other) const
+{
+    return _ptr == other._ptr;
+}
+
+template <class T, class S, class A>
+bool basic_many_producer_single_consumer_buffer<T, S, A>::wait_iterator::
+operator!=(const wait_iterator& other) const
+{
+    return _ptr != other._ptr;
+}
 
 } // namespace utils_tm
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
+#include "../allocators/node_pool_alloc.hpp"
 #include "../concurrency/memory_order.hpp"
 #include "../debug.hpp"
 #include "../mark_pointer.hpp"
@@ -18,20 +23,34 @@ namespace rtm  = reclamation_tm;
 
 template <class Value>
 using hzrd = utils_tm::reclamation_tm::hazard_manager<Value>;
-
-template <class Value, template <class> class RecMngr = hzrd>
+template <class Value>
+using pool_alloc = utils_tm::allocators_tm::node_pool_allocator<Value>;
+
+// Nodes are allocated through the reclamation manager, which is rebound to
+// use Allocator.  The default node_pool_allocator keeps thread local free
+// lists, i.e., nodes reclaimed by a handle are reused by the next push of the
+// same thread, without going through the system allocator.
+template <class Value,
+          template <class> class RecMngr = hzrd,
+          class Allocator                = pool_alloc<Value>>
 class protected_singly_linked_list
 {
   private:
-    using this_type = protected_singly_linked_list<Value, RecMngr>;
+    using this_type = protected_singly_linked_list<Value, RecMngr, Allocator>;
     using memo      = concurrency_tm::standard_memory_order_policy;
 
   public:
     class queue_item_type
     {
       public:
-        using value_type               = Value;
-        using reclamation_manager_type = RecMngr<queue_item_type>;
+        using value_type = Value;
+        // only the allocator is replaced, the destructor of RecMngr is kept
+        using base_manager_type = RecMngr<queue_item_type>;
+        using reclamation_manager_type =
+            typename base_manager_type::template rebind<
+                queue_item_type,
+                typename base_manager_type::destructor_type,
+                Allocator>::other;
         using atomic_queue_item_ptr =
             typename reclamation_manager_type::atomic_pointer_type;
 
@@ -49,6 +68,8 @@ class protected_singly_linked_list
         typename reclamation_manager_type::atomic_pointer_type;
     using queue_item_ptr = typename reclamation_manager_type::pointer_type;
     using guard_type     = typename reclamation_manager_type::guard_type;
+    using allocator_type = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<queue_item_type>;
 
     template <bool is_const>
     class iterator_base
@@ -87,7 +108,61 @@ class protected_singly_linked_list
     using iterator_type       = iterator_base<false>;
     using const_iterator_type = iterator_base<true>;
 
-    protected_singly_linked_list() : _head(nullptr) {}
+    // Weakly consistent iterator, that protects the elements in batches
+    // (all elements of the current batch stay protected until the next batch
+    // is loaded, only the last one stays protected while the next batch is
+    // protected, i.e., at most batch_size + 1 protections).  For managers
+    // with a fixed number of protections per handle (max_protections),
+    // batch_size is capped at half of them, the rest is left to the caller.
+    // Logically deleted elements are skipped.  A batch ends at a marked
+    // element (its successor might already be reclaimed), the scan ends
+    // early, if the last element of a batch is marked or unlinked.
+    class snapshot_iterator
+    {
+      public:
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = const Value;
+        using reference         = value_type&;
+        using pointer           = value_type*;
+        using iterator_category = std::forward_iterator_tag;
+
+        snapshot_iterator(reclamation_handle_type& h, size_t batch_size);
+        snapshot_iterator(reclamation_handle_type&     h,
+                          const atomic_queue_item_ptr& head,
+                          size_t                       batch_size);
+        snapshot_iterator(const snapshot_iterator&)            = delete;
+        snapshot_iterator& operator=(const snapshot_iterator&) = delete;
+        snapshot_iterator(snapshot_iterator&& other) noexcept;
+        snapshot_iterator& operator=(snapshot_iterator&& other) noexcept;
+        ~snapshot_iterator();
+
+        inline reference operator*() const { return _batch[_pos]->value; }
+        inline pointer   operator->() const { return &(_batch[_pos]->value); }
+
+        inline snapshot_iterator& operator++();
+
+        inline bool operator==(const snapshot_iterator& other) const;
+        inline bool operator!=(const snapshot_iterator& other) const;
+
+      private:
+        static inline size_t cap_batch_size(size_t batch_size);
+
+        reclamation_handle_type*    _h;
+        size_t                      _batch_size;
+        size_t                      _pos;
+        std::vector<queue_item_ptr> _batch;
+        std::vector<queue_item_ptr> _next;
+
+        inline queue_item_ptr current() const;
+        inline void           load(queue_item_ptr               owner,
+                                   const atomic_queue_item_ptr& link);
+        inline void           skip_deleted();
+    };
+
+    protected_singly_linked_list(allocator_type alloc = {})
+        : _allocator(alloc), _head(nullptr)
+    {
+    }
     protected_singly_linked_list(
         protected_singly_linked_list&& source) noexcept;
     protected_singly_linked_list&
@@ -104,6 +179,8 @@ class protected_singly_linked_list
     bool contains(reclamation_handle_type& h, const value_type& element);
 
     size_t size(reclamation_handle_type& h);
+    // sum of the striped insert/erase counters, not linearizable
+    size_t approximate_size() const;
 
     inline iterator_type       begin(reclamation_handle_type& h);
     inline const_iterator_type begin(reclamation_handle_type& h) const;
@@ -112,8 +189,24 @@ class protected_singly_linked_list
     inline const_iterator_type end(reclamation_handle_type& h) const;
     inline const_iterator_type cend(reclamation_handle_type& h) const;
 
+    inline snapshot_iterator snapshot_begin(reclamation_handle_type& h,
+                                            size_t batch_size = 32) const;
+    inline snapshot_iterator snapshot_end(reclamation_handle_type& h) const;
+
   private:
-    atomic_queue_item_ptr _head;
+    // each thread updates one of the size stripes
+    static constexpr size_t size_stripes = 16;
+    struct alignas(64) size_stripe
+    {
+        std::atomic<int64_t> count{0};
+    };
+
+    [[no_unique_address]] allocator_type _allocator;
+    atomic_queue_item_ptr                _head;
+    size_stripe                          _size[size_stripes];
+
+    inline void          update_size(int64_t diff);
+    static inline size_t stripe_index();
 
     inline iterator_type       make_iterator(guard_type&& guard);
     inline const_iterator_type make_citerator(guard_type&& guard) const;
@@ -141,6 +234,7 @@ class protected_singly_linked_list
         bool          contains(const value_type& element);
 
         size_t size();
+        size_t approximate_size() const;
 
         inline iterator_type       begin();
         inline const_iterator_type begin() const;
@@ -149,6 +243,9 @@ class protected_singly_linked_list
         inline const_iterator_type end() const;
         inline const_iterator_type cend() const;
 
+        inline snapshot_iterator snapshot_begin(size_t batch_size = 32) const;
+        inline snapshot_iterator snapshot_end() const;
+
       private:
         protected_singly_linked_list& _list;
         reclamation_handle_type&      _prot;
@@ -161,18 +258,22 @@ class protected_singly_linked_list
 
 
 // no concurrent operations on source are allowed
-template <class V, template <class> class R>
-protected_singly_linked_list<V, R>::protected_singly_linked_list(
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>::protected_singly_linked_list(
     protected_singly_linked_list&& source) noexcept
+    : _allocator(source._allocator)
 {
     auto temp = source._head.exchange(nullptr, memo::acq_rel);
     _head.store(temp, memo::relaxed);
+    for (size_t i = 0; i < size_stripes; ++i)
+        _size[i].count.store(source._size[i].count.exchange(0, memo::acq_rel),
+                             memo::relaxed);
 }
 
 // no concurrent operations (both on source or target)
-template <class V, template <class> class R>
-protected_singly_linked_list<V, R>&
-protected_singly_linked_list<V, R>::operator=(
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>&
+protected_singly_linked_list<V, R, A>::operator=(
     protected_singly_linked_list&& source) noexcept
 {
     if (this == &source) return *this;
@@ -181,40 +282,45 @@ protected_singly_linked_list<V, R>::operator=(
     return *this;
 }
 
-// no concurrent operations allowed
-template <class V, template <class> class R>
-protected_singly_linked_list<V, R>::~protected_singly_linked_list()
+// no concurrent operations allowed, the elements were created by handles of
+// a reclamation manager, therefore, they are freed through a manager of the
+// same type (with its allocator)
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>::~protected_singly_linked_list()
 {
+    reclamation_manager_type manager;
+
     auto temp = _head.exchange(nullptr, memo::relaxed);
     while (temp)
     {
-        auto next = temp->next.load(memo::relaxed);
-        delete temp;
+        auto next = mark::clear(temp->next.load(memo::relaxed));
+        manager.delete_raw(temp);
         temp = next;
     }
 }
 
-template <class V, template <class> class R>
-void protected_singly_linked_list<V, R>::push(reclamation_handle_type& h,
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::push(reclamation_handle_type& h,
                                               V                        element)
 {
     queue_item_type* item = h.create_pointer(std::move(element));
     push(h, item);
 }
 
-template <class V, template <class> class R>
-void protected_singly_linked_list<V, R>::push(
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::push(
     [[maybe_unused]] reclamation_handle_type& h, queue_item_type* item)
 {
     auto temp = _head.load(memo::acquire);
     do {
         item->next.store(temp, memo::relaxed);
     } while (!_head.compare_exchange_weak(temp, item, memo::acq_rel));
+    update_size(1);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::push_or_find(reclamation_handle_type& h,
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::push_or_find(reclamation_handle_type& h,
                                                  V element)
 {
     auto item = rtm::make_rec_guard(h, h.create_pointer(std::move(element)));
@@ -226,7 +332,10 @@ protected_singly_linked_list<V, R>::push_or_find(reclamation_handle_type& h,
         {
             queue_item_ptr temp = nullptr;
             if (_head.compare_exchange_weak(temp, item, memo::release))
+            {
+                update_size(1);
                 return make_iterator(std::move(item));
+            }
         }
 
         auto prev = guard_type(h);
@@ -254,7 +363,10 @@ protected_singly_linked_list<V, R>::push_or_find(reclamation_handle_type& h,
                 queue_item_ptr temp = nullptr;
                 if (curr->next.compare_exchange_strong(temp, item,
                                                        memo::acq_rel))
+                {
+                    update_size(1);
                     return make_iterator(std::move(item));
+                }
                 continue;
             }
             // we might have to help removing the element
@@ -276,9 +388,9 @@ protected_singly_linked_list<V, R>::push_or_find(reclamation_handle_type& h,
     }
 }
 
-template <class V, template <class> class R>
-size_t
-protected_singly_linked_list<V, R>::erase(reclamation_handle_type& h, V element)
+template <class V, template <class> class R, class A>
+size_t protected_singly_linked_list<V, R, A>::erase(reclamation_handle_type& h,
+                                               V                        element)
 {
     while (true)
     {
@@ -305,6 +417,7 @@ protected_singly_linked_list<V, R>::erase(reclamation_handle_type& h, V element)
                 queue_item_ptr temp = next;
                 if (!mark::atomic_mark<1>(curr->next, temp)) { continue; }
                 remove(h, prev, curr, next);
+                update_size(-1);
                 return 1;
             }
             // curr has no next
@@ -334,9 +447,9 @@ protected_singly_linked_list<V, R>::erase(reclamation_handle_type& h, V element)
 
 
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::find(reclamation_handle_type& h,
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::find(reclamation_handle_type& h,
                                          const V&                 element)
 {
     while (true)
@@ -383,15 +496,15 @@ protected_singly_linked_list<V, R>::find(reclamation_handle_type& h,
     }
 }
 
-template <class V, template <class> class R>
-bool protected_singly_linked_list<V, R>::contains(reclamation_handle_type& h,
+template <class V, template <class> class R, class A>
+bool protected_singly_linked_list<V, R, A>::contains(reclamation_handle_type& h,
                                                   const V& element)
 {
     return find(h, element) != end();
 }
 
-template <class V, template <class> class R>
-size_t protected_singly_linked_list<V, R>::size(reclamation_handle_type& h)
+template <class V, template <class> class R, class A>
+size_t protected_singly_linked_list<V, R, A>::size(reclamation_handle_type& h)
 {
     while (true)
     {
@@ -432,73 +545,114 @@ size_t protected_singly_linked_list<V, R>::size(reclamation_handle_type& h)
 }
 
 
+template <class V, template <class> class R, class A>
+size_t protected_singly_linked_list<V, R, A>::approximate_size() const
+{
+    int64_t result = 0;
+    for (auto& stripe : _size) result += stripe.count.load(memo::relaxed);
+    return (result < 0) ? 0 : size_t(result);
+}
+
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::update_size(int64_t diff)
+{
+    _size[stripe_index()].count.fetch_add(diff, memo::relaxed);
+}
+
+// threads are assigned to the stripes round robin
+template <class V, template <class> class R, class A>
+size_t protected_singly_linked_list<V, R, A>::stripe_index()
+{
+    static std::atomic_size_t next_stripe{0};
+    thread_local size_t       index =
+        next_stripe.fetch_add(1, memo::relaxed) % size_stripes;
+    return index;
+}
+
+
 
 // ITERATOR STUFF
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::begin(reclamation_handle_type& h)
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::begin(reclamation_handle_type& h)
 {
     auto temp = h.guard(_head);
     return make_iterator(std::move(temp));
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::begin(reclamation_handle_type& h) const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::begin(reclamation_handle_type& h) const
 {
     auto temp = h.guard(_head);
     return make_citerator(std::move(temp));
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::cbegin(reclamation_handle_type& h) const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::cbegin(reclamation_handle_type& h) const
 {
     auto temp = h.guard(_head);
     return make_citerator(std::move(temp));
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::end(reclamation_handle_type& h)
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::end(reclamation_handle_type& h)
 {
     return make_iterator(guard_type(h));
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::end(reclamation_handle_type& h) const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::end(reclamation_handle_type& h) const
 {
     return make_citerator(guard_type(h));
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::cend(reclamation_handle_type& h) const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::cend(reclamation_handle_type& h) const
 {
     return make_citerator(guard_type(h));
 }
 
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::snapshot_iterator
+protected_singly_linked_list<V, R, A>::snapshot_begin(
+    reclamation_handle_type& h, size_t batch_size) const
+{
+    return snapshot_iterator(h, _head, batch_size);
+}
+
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::snapshot_iterator
+protected_singly_linked_list<V, R, A>::snapshot_end(
+    reclamation_handle_type& h) const
+{
+    return snapshot_iterator(h, 0);
+}
+
 
 // MAKE ITERATOR STUFF
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::make_iterator(guard_type&& guard)
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::make_iterator(guard_type&& guard)
 {
     return iterator_type(std::move(guard));
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::make_citerator(guard_type&& guard) const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::make_citerator(guard_type&& guard) const
 {
     return const_iterator_type(std::move(guard));
 }
 
 
-template <class V, template <class> class R>
-void protected_singly_linked_list<V, R>::remove(reclamation_handle_type& h,
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::remove(reclamation_handle_type& h,
                                                 guard_type&              prev,
                                                 guard_type&              curr,
                                                 guard_type&              next)
@@ -535,56 +689,57 @@ void protected_singly_linked_list<V, R>::remove(reclamation_handle_type& h,
 
 
 // ITERATOR IMPLEMENTATION
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 template <bool c>
-typename protected_singly_linked_list<V,
-                                      R>::template iterator_base<c>::reference
-protected_singly_linked_list<V, R>::iterator_base<c>::operator*() const
+typename protected_singly_linked_list<V, R, A>::template iterator_base<
+    c>::reference
+protected_singly_linked_list<V, R, A>::iterator_base<c>::operator*() const
 {
     return _guard->value;
 }
 
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 template <bool c>
-typename protected_singly_linked_list<V, R>::template iterator_base<c>::pointer
-protected_singly_linked_list<V, R>::iterator_base<c>::operator->() const
+typename protected_singly_linked_list<V, R, A>::template iterator_base<
+    c>::pointer
+protected_singly_linked_list<V, R, A>::iterator_base<c>::operator->() const
 {
     return &(_guard->value);
 }
 
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 template <bool c>
-typename protected_singly_linked_list<V, R>::template iterator_base<
+typename protected_singly_linked_list<V, R, A>::template iterator_base<
     c>::iterator_base&
-protected_singly_linked_list<V, R>::iterator_base<c>::operator++()
+protected_singly_linked_list<V, R, A>::iterator_base<c>::operator++()
 {
     guard_type tguard = rtm::add_guard(_guard, _guard->next);
     _guard            = std::move(tguard);
     return *this;
 }
 
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 template <bool c>
-typename protected_singly_linked_list<V, R>::template iterator_base<
+typename protected_singly_linked_list<V, R, A>::template iterator_base<
     c>::iterator_base&
-protected_singly_linked_list<V, R>::iterator_base<c>::operator++(int)
+protected_singly_linked_list<V, R, A>::iterator_base<c>::operator++(int)
 {
     guard_type tguard = rtm::add_guard(_guard, _guard->next);
     std::swap(_guard, tguard);
     return iterator_base(std::move(tguard));
 }
 
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 template <bool c>
-bool protected_singly_linked_list<V, R>::iterator_base<c>::operator==(
+bool protected_singly_linked_list<V, R, A>::iterator_base<c>::operator==(
     const iterator_base& other) const
 {
     return queue_item_ptr(_guard) == queue_item_ptr(other._guard);
 }
 
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 template <bool c>
-bool protected_singly_linked_list<V, R>::iterator_base<c>::operator!=(
+bool protected_singly_linked_list<V, R, A>::iterator_base<c>::operator!=(
     const iterator_base& other) const
 {
     return queue_item_ptr(_guard) != queue_item_ptr(other._guard);
@@ -592,95 +747,272 @@ bool protected_singly_linked_list<V, R>::iterator_base<c>::operator!=(
 
 
 
-template <class V, template <class> class R>
-void protected_singly_linked_list<V, R>::handle_type::push(value_type element)
+// SNAPSHOT ITERATOR IMPLEMENTATION
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>::snapshot_iterator::snapshot_iterator(
+    reclamation_handle_type& h, size_t batch_size)
+    : _h(&h), _batch_size(cap_batch_size(batch_size)), _pos(0)
+{
+}
+
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>::snapshot_iterator::snapshot_iterator(
+    reclamation_handle_type&     h,
+    const atomic_queue_item_ptr& head,
+    size_t                       batch_size)
+    : _h(&h), _batch_size(cap_batch_size(batch_size)), _pos(0)
+{
+    _batch.reserve(_batch_size);
+    _next.reserve(_batch_size);
+    load(nullptr, head);
+    skip_deleted();
+}
+
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>::snapshot_iterator::snapshot_iterator(
+    snapshot_iterator&& other) noexcept
+    : _h(other._h), _batch_size(other._batch_size), _pos(other._pos),
+      _batch(std::move(other._batch)), _next(std::move(other._next))
+{
+    other._batch.clear();
+    other._next.clear();
+}
+
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::snapshot_iterator&
+protected_singly_linked_list<V, R, A>::snapshot_iterator::operator=(
+    snapshot_iterator&& other) noexcept
+{
+    if (this == &other) return *this;
+    this->~snapshot_iterator();
+    new (this) snapshot_iterator(std::move(other));
+    return *this;
+}
+
+template <class V, template <class> class R, class A>
+protected_singly_linked_list<V, R, A>::snapshot_iterator::~snapshot_iterator()
+{
+    _h->unprotect(_batch);
+}
+
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::snapshot_iterator&
+protected_singly_linked_list<V, R, A>::snapshot_iterator::operator++()
+{
+    ++_pos;
+    skip_deleted();
+    return *this;
+}
+
+template <class V, template <class> class R, class A>
+bool protected_singly_linked_list<V, R, A>::snapshot_iterator::operator==(
+    const snapshot_iterator& other) const
+{
+    return current() == other.current();
+}
+
+template <class V, template <class> class R, class A>
+bool protected_singly_linked_list<V, R, A>::snapshot_iterator::operator!=(
+    const snapshot_iterator& other) const
+{
+    return current() != other.current();
+}
+
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::queue_item_ptr
+protected_singly_linked_list<V, R, A>::snapshot_iterator::current() const
+{
+    return (_pos < _batch.size()) ? _batch[_pos] : nullptr;
+}
+
+template <class V, template <class> class R, class A>
+size_t protected_singly_linked_list<V, R, A>::snapshot_iterator::cap_batch_size(
+    size_t batch_size)
+{
+    if constexpr (requires { reclamation_manager_type::max_protections; })
+        batch_size = std::min<size_t>(
+            batch_size, reclamation_manager_type::max_protections / 2);
+    return std::max<size_t>(batch_size, 1);
+}
+
+// releases the old batch (except for owner, its last element), then protects
+// the next batch (following link, which is stored in owner)
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::snapshot_iterator::load(
+    queue_item_ptr owner, const atomic_queue_item_ptr& link)
+{
+    auto last = owner;
+    if (!_batch.empty()) _batch.pop_back();
+    _h->unprotect(_batch);
+    _batch.clear();
+
+    auto next = &link;
+    _next.clear();
+    while (_next.size() < _batch_size)
+    {
+        queue_item_ptr raw = _h->protect(*next);
+        queue_item_ptr ptr = mark::clear(raw);
+        if (!ptr) break;
+        if (next->load(memo::acquire) != raw)
+        {
+            // the link changed after ptr was protected -> reload it
+            _h->unprotect(ptr);
+            continue;
+        }
+        if (raw != ptr || ptr == owner)
+        {
+            // owner is marked (ptr might already be reclaimed), or it was
+            // unlinked (see remove)
+            _h->unprotect(ptr);
+            break;
+        }
+        _next.push_back(ptr);
+        owner = ptr;
+        next  = &ptr->next;
+    }
+
+    if (last) _h->unprotect(last);
+    std::swap(_batch, _next);
+    _next.clear();
+    _pos = 0;
+}
+
+// moves forward until the current element is neither marked nor unlinked
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::snapshot_iterator::skip_deleted()
+{
+    while (true)
+    {
+        if (_pos == _batch.size())
+        {
+            if (_batch.empty()) return;
+            auto last = _batch.back();
+            load(last, last->next);
+            if (_batch.empty()) return;
+        }
+
+        auto curr = _batch[_pos];
+        auto next = curr->next.load(memo::acquire);
+        if (!mark::is_marked(next) && next != curr) return;
+        ++_pos;
+    }
+}
+
+
+
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::handle_type::push(
+    value_type element)
 {
     _list.push(_prot, element);
 }
 
-template <class V, template <class> class R>
-void protected_singly_linked_list<V, R>::handle_type::push(
+template <class V, template <class> class R, class A>
+void protected_singly_linked_list<V, R, A>::handle_type::push(
     queue_item_type* item)
 {
     _list.push(_prot, item);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::handle_type::push_or_find(
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::push_or_find(
     value_type element)
 {
     return _list.push_or_find(_prot, element);
 }
 
-template <class V, template <class> class R>
+template <class V, template <class> class R, class A>
 size_t
-protected_singly_linked_list<V, R>::handle_type::erase(value_type element)
+protected_singly_linked_list<V, R, A>::handle_type::erase(value_type element)
 {
     return _list.erase(_prot, element);
 }
 
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::handle_type::find(const value_type& element)
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::find(
+    const value_type& element)
 {
     return _list.find(_prot, element);
 }
 
-template <class V, template <class> class R>
-bool protected_singly_linked_list<V, R>::handle_type::contains(
+template <class V, template <class> class R, class A>
+bool protected_singly_linked_list<V, R, A>::handle_type::contains(
     const value_type& element)
 {
     return _list.contains(_prot, element);
 }
 
-template <class V, template <class> class R>
-size_t protected_singly_linked_list<V, R>::handle_type::size()
+template <class V, template <class> class R, class A>
+size_t protected_singly_linked_list<V, R, A>::handle_type::size()
 {
     return _list.size(_prot);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::handle_type::begin()
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::begin()
 {
     return _list.begin(_prot);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::handle_type::begin() const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::begin() const
 {
     return _list.begin(_prot);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::handle_type::cbegin() const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::cbegin() const
 {
     return _list.cbegin(_prot);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::iterator_type
-protected_singly_linked_list<V, R>::handle_type::end()
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::end()
 {
     return _list.end(_prot);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::handle_type::end() const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::end() const
 {
     return _list.end(_prot);
 }
 
-template <class V, template <class> class R>
-typename protected_singly_linked_list<V, R>::const_iterator_type
-protected_singly_linked_list<V, R>::handle_type::cend() const
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::const_iterator_type
+protected_singly_linked_list<V, R, A>::handle_type::cend() const
 {
     return _list.cend(_prot);
 }
 
+template <class V, template <class> class R, class A>
+size_t
+protected_singly_linked_list<V, R, A>::handle_type::approximate_size() const
+{
+    return _list.approximate_size();
+}
+
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::snapshot_iterator
+protected_singly_linked_list<V, R, A>::handle_type::snapshot_begin(
+    size_t batch_size) const
+{
+    return _list.snapshot_begin(_prot, batch_size);
+}
+
+template <class V, template <class> class R, class A>
+typename protected_singly_linked_list<V, R, A>::snapshot_iterator
+protected_singly_linked_list<V, R, A>::handle_type::snapshot_end() const
+{
+    return _list.snapshot_end(_prot);
+}
+
 } // namespace utils_tm
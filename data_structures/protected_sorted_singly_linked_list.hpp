@@ -0,0 +1,628 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <utility>
+
+#include "../concurrency/memory_order.hpp"
+#include "../mark_pointer.hpp"
+#include "../memory_reclamation/reclamation_guard.hpp"
+#include "protected_singly_linked_list.hpp"
+
+
+namespace utils_tm
+{
+
+// Sorted variant of the protected_singly_linked_list (Harris-Michael list).
+// Elements are kept in ascending order (according to Compare), therefore,
+// find, erase, and failed searches can stop at the first element that is not
+// smaller than the searched one.  Removed elements are logically deleted by
+// marking their next pointer, all traversals help unlinking marked elements.
+// Elements are unique, push (like insert) ignores elements that are already
+// present.  Thus, a marked element can never hide behind an equal one, and
+// iterators can resume behind a marked element by searching its value.
+//
+// insert, erase, and find can also start at a given element instead of the
+// head (start has to precede the searched element and may never be erased,
+// i.e., it has to be some kind of sentinel, see split_ordered_hash_set).
+template <class Value,
+          template <class> class RecMngr = hzrd,
+          class Compare                  = std::less<Value>>
+class protected_sorted_singly_linked_list
+{
+  private:
+    using this_type =
+        protected_sorted_singly_linked_list<Value, RecMngr, Compare>;
+    using memo = concurrency_tm::standard_memory_order_policy;
+
+  public:
+    class queue_item_type
+    {
+      public:
+        using value_type               = Value;
+        using reclamation_manager_type = RecMngr<queue_item_type>;
+        using atomic_queue_item_ptr =
+            typename reclamation_manager_type::atomic_pointer_type;
+
+        queue_item_type(value_type t) : value(std::move(t)), next(nullptr) {}
+        value_type            value;
+        atomic_queue_item_ptr next;
+    };
+
+    using value_type = Value;
+    using reclamation_manager_type =
+        typename queue_item_type::reclamation_manager_type;
+    using reclamation_handle_type =
+        typename reclamation_manager_type::handle_type;
+    using atomic_queue_item_ptr =
+        typename reclamation_manager_type::atomic_pointer_type;
+    using queue_item_ptr = typename reclamation_manager_type::pointer_type;
+    using guard_type     = typename reclamation_manager_type::guard_type;
+
+    template <bool is_const>
+    class iterator_base
+    {
+      private:
+        using this_type = iterator_base<is_const>;
+        using list_type = protected_sorted_singly_linked_list;
+
+        list_type*               _list;
+        reclamation_handle_type* _handle;
+        queue_item_ptr           _start;
+        guard_type               _guard;
+
+      public:
+        using difference_type = std::ptrdiff_t;
+        using value_type =
+            typename std::conditional<is_const, const Value, Value>::type;
+        using reference         = value_type&;
+        using pointer           = value_type*;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator_base(list_type*               list,
+                      reclamation_handle_type& h,
+                      queue_item_ptr           start,
+                      guard_type               guard)
+            : _list(list), _handle(&h), _start(start), _guard(std::move(guard))
+        {
+        }
+        iterator_base(iterator_base&& other)            = default;
+        iterator_base& operator=(iterator_base&& other) = default;
+        ~iterator_base()                                = default;
+
+        inline reference operator*() const;
+        inline pointer   operator->() const;
+
+        inline iterator_base& operator++();
+
+        inline bool operator==(const iterator_base& other) const;
+        inline bool operator!=(const iterator_base& other) const;
+
+        inline queue_item_ptr item() const { return _guard; }
+    };
+
+    using iterator_type       = iterator_base<false>;
+    using const_iterator_type = iterator_base<true>;
+
+    protected_sorted_singly_linked_list(Compare comp = {})
+        : _comp(std::move(comp)), _head(nullptr)
+    {
+    }
+    protected_sorted_singly_linked_list(
+        protected_sorted_singly_linked_list&& source) noexcept;
+    protected_sorted_singly_linked_list&
+    operator=(protected_sorted_singly_linked_list&& source) noexcept;
+    ~protected_sorted_singly_linked_list();
+
+    // does nothing if an equal element is already present
+    inline void push(reclamation_handle_type& h, value_type element);
+    inline iterator_type
+                  push_or_find(reclamation_handle_type& h, value_type element);
+    inline size_t erase(reclamation_handle_type& h, const value_type& element);
+
+    iterator_type find(reclamation_handle_type& h, const value_type& element);
+    bool contains(reclamation_handle_type& h, const value_type& element);
+
+    inline std::pair<iterator_type, bool> insert(reclamation_handle_type& h,
+                                                 queue_item_ptr           start,
+                                                 value_type element);
+    inline size_t        erase(reclamation_handle_type& h,
+                               queue_item_ptr           start,
+                               const value_type&        element);
+    inline iterator_type find(reclamation_handle_type& h,
+                              queue_item_ptr           start,
+                              const value_type&        element);
+
+    size_t size(reclamation_handle_type& h);
+
+    inline iterator_type       begin(reclamation_handle_type& h);
+    inline const_iterator_type cbegin(reclamation_handle_type& h) const;
+    inline iterator_type       end(reclamation_handle_type& h);
+    inline const_iterator_type cend(reclamation_handle_type& h) const;
+
+  private:
+    [[no_unique_address]] Compare _comp;
+    atomic_queue_item_ptr         _head;
+
+    inline bool equal(const value_type& a, const value_type& b) const
+    {
+        return !_comp(a, b) && !_comp(b, a);
+    }
+    inline atomic_queue_item_ptr& link(guard_type& prev)
+    {
+        return (prev) ? prev->next : _head;
+    }
+    inline void search(reclamation_handle_type& h,
+                       queue_item_ptr           start,
+                       const value_type&        element,
+                       guard_type&              prev,
+                       guard_type&              curr);
+    inline guard_type next_unmarked(reclamation_handle_type& h,
+                                    queue_item_ptr           start,
+                                    guard_type               curr);
+    inline guard_type skip_deleted(reclamation_handle_type& h,
+                                   queue_item_ptr           start,
+                                   guard_type               curr);
+
+  public:
+    class handle_type
+    {
+      public:
+        handle_type(protected_sorted_singly_linked_list& list,
+                    reclamation_handle_type&             prot)
+            : _list(list), _prot(prot)
+        {
+        }
+
+        inline void          push(value_type element);
+        inline iterator_type push_or_find(value_type element);
+        inline size_t        erase(const value_type& element);
+
+        iterator_type find(const value_type& element);
+        bool          contains(const value_type& element);
+
+        size_t size();
+
+        inline iterator_type       begin();
+        inline const_iterator_type cbegin() const;
+        inline iterator_type       end();
+        inline const_iterator_type cend() const;
+
+      private:
+        protected_sorted_singly_linked_list& _list;
+        reclamation_handle_type&             _prot;
+    };
+    handle_type get_handle(reclamation_handle_type& h)
+    {
+        return handle_type(*this, h);
+    }
+};
+
+
+// no concurrent operations on source are allowed
+template <class V, template <class> class R, class C>
+protected_sorted_singly_linked_list<V, R, C>::
+    protected_sorted_singly_linked_list(
+        protected_sorted_singly_linked_list&& source) noexcept
+    : _comp(std::move(source._comp)),
+      _head(source._head.exchange(nullptr, memo::acq_rel))
+{
+}
+
+// no concurrent operations (both on source or target)
+template <class V, template <class> class R, class C>
+protected_sorted_singly_linked_list<V, R, C>&
+protected_sorted_singly_linked_list<V, R, C>::operator=(
+    protected_sorted_singly_linked_list&& source) noexcept
+{
+    if (this == &source) return *this;
+    this->~protected_sorted_singly_linked_list();
+    new (this) protected_sorted_singly_linked_list(std::move(source));
+    return *this;
+}
+
+// no concurrent operations allowed, the elements were created by handles of
+// a reclamation manager, therefore, they are freed through a manager of the
+// same type (with its allocator)
+template <class V, template <class> class R, class C>
+protected_sorted_singly_linked_list<V, R, C>::
+    ~protected_sorted_singly_linked_list()
+{
+    reclamation_manager_type manager;
+
+    auto temp = _head.exchange(nullptr, memo::relaxed);
+    while (temp)
+    {
+        auto next = mark::clear(temp->next.load(memo::relaxed));
+        manager.delete_raw(temp);
+        temp = next;
+    }
+}
+
+
+
+// finds the first element that is not smaller than element (curr), and its
+// predecessor (prev, empty if curr is the head), marked elements on the way
+// are unlinked.  A protected successor is only used, if the link it was
+// loaded from still holds it (unmarked), since protect ignores marks and the
+// successor of a marked element can already be reclaimed.
+template <class V, template <class> class R, class C>
+void protected_sorted_singly_linked_list<V, R, C>::search(
+    reclamation_handle_type& h,
+    queue_item_ptr           start,
+    const V&                 element,
+    guard_type&              prev,
+    guard_type&              curr)
+{
+    while (true)
+    {
+        prev = (start) ? h.guard(start) : guard_type(h);
+        curr = h.guard(link(prev));
+        if (link(prev).load(memo::acquire) != queue_item_ptr(curr)) continue;
+
+        while (curr)
+        {
+            auto           next = h.guard(curr->next);
+            queue_item_ptr nptr = next;
+            if (curr->next.load(memo::acquire) != nptr)
+                break; // curr has changed -> start from head
+
+            // curr is logically deleted -> unlink it
+            if (mark::is_marked(nptr))
+            {
+                queue_item_ptr temp = curr;
+                if (!link(prev).compare_exchange_strong(
+                        temp, mark::clear(nptr), memo::acq_rel))
+                    break; // prev has changed -> start from head
+                h.safe_delete(temp);
+                curr = std::move(next);
+                curr.unmark();
+                continue;
+            }
+
+            if (!_comp(curr->value, element)) return;
+
+            prev = std::move(curr);
+            curr = std::move(next);
+        }
+        if (!curr) return;
+    }
+}
+
+// finds the first unmarked element behind curr.  The successor is only
+// protected through an unmarked element, the next pointer of a marked
+// element might point to an already reclaimed element.  Therefore, once curr
+// is marked, the position is recomputed by searching its value from start
+// (equal elements are skipped, the value was already visited).
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::guard_type
+protected_sorted_singly_linked_list<V, R, C>::next_unmarked(
+    reclamation_handle_type& h, queue_item_ptr start, guard_type curr)
+{
+    auto prev = guard_type(h);
+    while (true)
+    {
+        auto           succ = guard_type(h);
+        queue_item_ptr next = curr->next.load(memo::acquire);
+        if (mark::is_marked(next))
+        {
+            search(h, start, curr->value, prev, succ);
+            if (succ && !_comp(curr->value, succ->value))
+            {
+                curr = std::move(succ);
+                continue;
+            }
+        }
+        else
+        {
+            succ = rtm::add_guard(curr, curr->next);
+            next = curr->next.load(memo::acquire);
+            if (next != queue_item_ptr(succ) || mark::is_marked(next))
+                continue;
+        }
+
+        if (!succ || !mark::is_marked(succ->next.load(memo::acquire)))
+            return succ;
+        curr = std::move(succ);
+    }
+}
+
+// returns curr, or the first unmarked element behind it (if curr is marked)
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::guard_type
+protected_sorted_singly_linked_list<V, R, C>::skip_deleted(
+    reclamation_handle_type& h, queue_item_ptr start, guard_type curr)
+{
+    curr.unmark();
+    if (curr && mark::is_marked(curr->next.load(memo::acquire)))
+        return next_unmarked(h, start, std::move(curr));
+    return curr;
+}
+
+template <class V, template <class> class R, class C>
+void protected_sorted_singly_linked_list<V, R, C>::push(
+    reclamation_handle_type& h, V element)
+{
+    insert(h, nullptr, std::move(element));
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::push_or_find(
+    reclamation_handle_type& h, V element)
+{
+    return insert(h, nullptr, std::move(element)).first;
+}
+
+template <class V, template <class> class R, class C>
+size_t
+protected_sorted_singly_linked_list<V, R, C>::erase(reclamation_handle_type& h,
+                                                    const V& element)
+{
+    return erase(h, nullptr, element);
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::find(reclamation_handle_type& h,
+                                                   const V& element)
+{
+    return find(h, nullptr, element);
+}
+
+template <class V, template <class> class R, class C>
+bool protected_sorted_singly_linked_list<V, R, C>::contains(
+    reclamation_handle_type& h, const V& element)
+{
+    return find(h, element) != end(h);
+}
+
+
+
+// the bool is true if the element was inserted (false if it was found)
+template <class V, template <class> class R, class C>
+std::pair<typename protected_sorted_singly_linked_list<V, R, C>::iterator_type,
+          bool>
+protected_sorted_singly_linked_list<V, R, C>::insert(reclamation_handle_type& h,
+                                                     queue_item_ptr start,
+                                                     V              element)
+{
+    auto item = rtm::make_rec_guard(h, h.create_pointer(std::move(element)));
+    auto prev = guard_type(h);
+    auto curr = guard_type(h);
+
+    while (true)
+    {
+        search(h, start, item->value, prev, curr);
+        if (curr && equal(curr->value, item->value))
+        {
+            h.delete_raw(item.release());
+            auto it = iterator_type(this, h, start, std::move(curr));
+            return std::make_pair(std::move(it), false);
+        }
+
+        queue_item_ptr temp = curr;
+        item->next.store(temp, memo::relaxed);
+        if (link(prev).compare_exchange_strong(temp, item, memo::acq_rel))
+        {
+            auto it = iterator_type(this, h, start, std::move(item));
+            return std::make_pair(std::move(it), true);
+        }
+    }
+}
+
+template <class V, template <class> class R, class C>
+size_t
+protected_sorted_singly_linked_list<V, R, C>::erase(reclamation_handle_type& h,
+                                                    queue_item_ptr start,
+                                                    const V&       element)
+{
+    auto prev = guard_type(h);
+    auto curr = guard_type(h);
+
+    while (true)
+    {
+        search(h, start, element, prev, curr);
+        if (!curr || !equal(curr->value, element)) return 0;
+
+        queue_item_ptr next = curr->next.load(memo::acquire);
+        if (mark::is_marked(next)) continue; // erased concurrently
+        if (!mark::atomic_mark<0>(curr->next, next, memo::acq_rel)) continue;
+
+        // try unlinking curr, otherwise the search cleans up behind us
+        queue_item_ptr temp = curr;
+        if (link(prev).compare_exchange_strong(temp, next, memo::acq_rel))
+            h.safe_delete(temp);
+        else
+            search(h, start, element, prev, curr);
+        return 1;
+    }
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::find(reclamation_handle_type& h,
+                                                   queue_item_ptr start,
+                                                   const V&       element)
+{
+    auto prev = guard_type(h);
+    auto curr = guard_type(h);
+
+    search(h, start, element, prev, curr);
+    if (!curr || !equal(curr->value, element)) return end(h);
+    return iterator_type(this, h, start, std::move(curr));
+}
+
+// counts the unmarked elements, not linearizable
+template <class V, template <class> class R, class C>
+size_t
+protected_sorted_singly_linked_list<V, R, C>::size(reclamation_handle_type& h)
+{
+    size_t result = 0;
+    for (auto it = begin(h); it != end(h); ++it) { ++result; }
+    return result;
+}
+
+
+
+// ITERATOR STUFF
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::begin(reclamation_handle_type& h)
+{
+    auto curr = skip_deleted(h, nullptr, h.guard(_head));
+    return iterator_type(this, h, nullptr, std::move(curr));
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::const_iterator_type
+protected_sorted_singly_linked_list<V, R, C>::cbegin(
+    reclamation_handle_type& h) const
+{
+    auto list = const_cast<protected_sorted_singly_linked_list*>(this);
+    auto curr = list->skip_deleted(h, nullptr, h.guard(_head));
+    return const_iterator_type(list, h, nullptr, std::move(curr));
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::end(reclamation_handle_type& h)
+{
+    return iterator_type(this, h, nullptr, guard_type(h));
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::const_iterator_type
+protected_sorted_singly_linked_list<V, R, C>::cend(
+    reclamation_handle_type& h) const
+{
+    auto list = const_cast<protected_sorted_singly_linked_list*>(this);
+    return const_iterator_type(list, h, nullptr, guard_type(h));
+}
+
+
+
+// ITERATOR IMPLEMENTATION
+template <class V, template <class> class R, class C>
+template <bool c>
+typename protected_sorted_singly_linked_list<V, R, C>::template iterator_base<
+    c>::reference
+protected_sorted_singly_linked_list<V, R, C>::iterator_base<c>::operator*()
+    const
+{
+    return _guard->value;
+}
+
+template <class V, template <class> class R, class C>
+template <bool c>
+typename protected_sorted_singly_linked_list<V, R, C>::template iterator_base<
+    c>::pointer
+protected_sorted_singly_linked_list<V, R, C>::iterator_base<c>::operator->()
+    const
+{
+    return &(_guard->value);
+}
+
+// skips all logically deleted elements
+template <class V, template <class> class R, class C>
+template <bool c>
+typename protected_sorted_singly_linked_list<V, R, C>::template iterator_base<
+    c>::iterator_base&
+protected_sorted_singly_linked_list<V, R, C>::iterator_base<c>::operator++()
+{
+    guard_type tguard =
+        _list->next_unmarked(*_handle, _start, std::move(_guard));
+    _guard            = std::move(tguard);
+    return *this;
+}
+
+template <class V, template <class> class R, class C>
+template <bool c>
+bool protected_sorted_singly_linked_list<V, R, C>::iterator_base<c>::operator==(
+    const iterator_base& other) const
+{
+    return queue_item_ptr(_guard) == queue_item_ptr(other._guard);
+}
+
+template <class V, template <class> class R, class C>
+template <bool c>
+bool protected_sorted_singly_linked_list<V, R, C>::iterator_base<c>::operator!=(
+    const iterator_base& other) const
+{
+    return queue_item_ptr(_guard) != queue_item_ptr(other._guard);
+}
+
+
+
+template <class V, template <class> class R, class C>
+void protected_sorted_singly_linked_list<V, R, C>::handle_type::push(
+    value_type element)
+{
+    _list.push(_prot, std::move(element));
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::handle_type::push_or_find(
+    value_type element)
+{
+    return _list.push_or_find(_prot, std::move(element));
+}
+
+template <class V, template <class> class R, class C>
+size_t protected_sorted_singly_linked_list<V, R, C>::handle_type::erase(
+    const value_type& element)
+{
+    return _list.erase(_prot, element);
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::handle_type::find(
+    const value_type& element)
+{
+    return _list.find(_prot, element);
+}
+
+template <class V, template <class> class R, class C>
+bool protected_sorted_singly_linked_list<V, R, C>::handle_type::contains(
+    const value_type& element)
+{
+    return _list.contains(_prot, element);
+}
+
+template <class V, template <class> class R, class C>
+size_t protected_sorted_singly_linked_list<V, R, C>::handle_type::size()
+{
+    return _list.size(_prot);
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::handle_type::begin()
+{
+    return _list.begin(_prot);
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::const_iterator_type
+protected_sorted_singly_linked_list<V, R, C>::handle_type::cbegin() const
+{
+    return _list.cbegin(_prot);
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::iterator_type
+protected_sorted_singly_linked_list<V, R, C>::handle_type::end()
+{
+    return _list.end(_prot);
+}
+
+template <class V, template <class> class R, class C>
+typename protected_sorted_singly_linked_list<V, R, C>::const_iterator_type
+protected_sorted_singly_linked_list<V, R, C>::handle_type::cend() const
+{
+    return _list.cend(_prot);
+}
+
+} // namespace utils_tm
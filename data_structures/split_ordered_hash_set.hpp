@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+
+#include "../concurrency/memory_order.hpp"
+#include "../default_hash.hpp"
+#include "../fastrange.hpp"
+#include "protected_sorted_singly_linked_list.hpp"
+
+namespace utils_tm
+{
+
+// Lock-free hash set based on split-ordered lists (Shalev and Shavit).
+// All elements are stored in one protected_sorted_singly_linked_list, sorted
+// by their hash.  A bucket is a dummy element that is inserted in front of
+// all elements whose hash has a given prefix.  Buckets are found with
+// fastrange64 (i.e. by the upper bits of the hash), thus, when the capacity
+// doubles, each bucket is split in two by inserting one new dummy element
+// into the existing list (no elements have to be moved).  New buckets are
+// initialized lazily by the first operation that accesses them.
+//
+// The bucket directory is indexed by the bit-reversed bucket prefix, this
+// index does not change when the capacity grows, and the parent of a bucket
+// (the bucket that is split) is found by clearing its highest bit.
+//
+// Key has to be default constructible (for the dummy elements), and
+// KeyCompare is only used to order elements with identical hashes.
+template <class Key,
+          class Hash                     = hash_tm::default_hash,
+          template <class> class RecMngr = hzrd,
+          class KeyCompare               = std::less<Key>>
+class split_ordered_hash_set
+{
+  private:
+    using this_type = split_ordered_hash_set<Key, Hash, RecMngr, KeyCompare>;
+    using memo      = concurrency_tm::standard_memory_order_policy;
+
+    struct entry_type
+    {
+        uint64_t hash;
+        bool     dummy;
+        Key      key;
+    };
+
+    // dummy elements are sorted in front of elements with the same hash
+    struct entry_compare
+    {
+        [[no_unique_address]] KeyCompare comp;
+
+        inline bool operator()(const entry_type& a, const entry_type& b) const
+        {
+            if (a.hash != b.hash) return a.hash < b.hash;
+            if (a.dummy != b.dummy) return a.dummy;
+            if (a.dummy) return false;
+            return comp(a.key, b.key);
+        }
+    };
+
+    using list_type =
+        protected_sorted_singly_linked_list<entry_type, RecMngr, entry_compare>;
+    using queue_item_ptr = typename list_type::queue_item_ptr;
+    using segment_type   = std::atomic<queue_item_ptr>;
+
+    static constexpr size_t _max_log         = 48;
+    static constexpr size_t _max_load_factor = 2;
+
+  public:
+    using key_type = Key;
+    using hasher   = Hash;
+    using reclamation_manager_type =
+        typename list_type::reclamation_manager_type;
+    using reclamation_handle_type =
+        typename list_type::reclamation_handle_type;
+
+    split_ordered_hash_set(size_t capacity = 64, Hash hash = {});
+    split_ordered_hash_set(const split_ordered_hash_set&)            = delete;
+    split_ordered_hash_set& operator=(const split_ordered_hash_set&) = delete;
+    ~split_ordered_hash_set();
+
+    inline bool   insert(reclamation_handle_type& h, const Key& key);
+    inline size_t erase(reclamation_handle_type& h, const Key& key);
+    inline bool   contains(reclamation_handle_type& h, const Key& key);
+
+    // approximate, since concurrent updates are counted independently
+    size_t size() const { return _size.load(memo::acquire); }
+    size_t capacity() const
+    {
+        return size_t(1) << _log_capacity.load(memo::acquire);
+    }
+
+  private:
+    [[no_unique_address]] Hash _hash;
+    list_type                  _list;
+    std::atomic_size_t         _log_capacity;
+    std::atomic_size_t         _size;
+    std::atomic<segment_type*> _segments[_max_log + 1];
+
+    static inline uint64_t reverse_bits(uint64_t x);
+
+    inline queue_item_ptr get_bucket(reclamation_handle_type& h,
+                                     uint64_t                 hash);
+    inline queue_item_ptr get_dummy(reclamation_handle_type& h, size_t index);
+    inline queue_item_ptr initialize_dummy(reclamation_handle_type& h,
+                                           size_t                   index);
+    inline segment_type&  directory_slot(size_t index);
+    inline void           grow(size_t size);
+};
+
+
+
+template <class K, class H, template <class> class R, class C>
+split_ordered_hash_set<K, H, R, C>::split_ordered_hash_set(size_t capacity,
+                                                           H      hash)
+    : _hash(std::move(hash)),
+      // a capacity of 0 is treated as 1 (capacity - 1 would wrap around)
+      _log_capacity(std::min<size_t>(
+          std::bit_width(std::max<size_t>(capacity, 1) - 1), _max_log)),
+      _size(0)
+{
+    for (auto& s : _segments) s.store(nullptr, memo::relaxed);
+}
+
+// no concurrent operations allowed
+template <class K, class H, template <class> class R, class C>
+split_ordered_hash_set<K, H, R, C>::~split_ordered_hash_set()
+{
+    // the list deletes all elements (including the dummies)
+    for (auto& s : _segments) delete[] s.exchange(nullptr, memo::relaxed);
+}
+
+
+
+template <class K, class H, template <class> class R, class C>
+bool split_ordered_hash_set<K, H, R, C>::insert(reclamation_handle_type& h,
+                                                const K&                 key)
+{
+    uint64_t hash   = _hash(key);
+    auto     bucket = get_bucket(h, hash);
+    auto     result = _list.insert(h, bucket, entry_type{hash, false, key});
+    if (result.second) grow(_size.fetch_add(1, memo::acq_rel) + 1);
+    return result.second;
+}
+
+template <class K, class H, template <class> class R, class C>
+size_t split_ordered_hash_set<K, H, R, C>::erase(reclamation_handle_type& h,
+                                                 const K&                 key)
+{
+    uint64_t hash   = _hash(key);
+    auto     bucket = get_bucket(h, hash);
+    auto     result = _list.erase(h, bucket, entry_type{hash, false, key});
+    if (result) _size.fetch_sub(result, memo::acq_rel);
+    return result;
+}
+
+template <class K, class H, template <class> class R, class C>
+bool split_ordered_hash_set<K, H, R, C>::contains(reclamation_handle_type& h,
+                                                  const K&                 key)
+{
+    uint64_t hash   = _hash(key);
+    auto     bucket = get_bucket(h, hash);
+    return _list.find(h, bucket, entry_type{hash, false, key}) != _list.end(h);
+}
+
+
+
+// HELPER FUNCTIONS
+template <class K, class H, template <class> class R, class C>
+uint64_t split_ordered_hash_set<K, H, R, C>::reverse_bits(uint64_t x)
+{
+    x = ((x >> 1) & 0x5555555555555555ull) |
+        ((x & 0x5555555555555555ull) << 1);
+    x = ((x >> 2) & 0x3333333333333333ull) |
+        ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 4) & 0x0f0f0f0f0f0f0f0full) |
+        ((x & 0x0f0f0f0f0f0f0f0full) << 4);
+    x = ((x >> 8) & 0x00ff00ff00ff00ffull) |
+        ((x & 0x00ff00ff00ff00ffull) << 8);
+    x = ((x >> 16) & 0x0000ffff0000ffffull) |
+        ((x & 0x0000ffff0000ffffull) << 16);
+    return (x >> 32) | (x << 32);
+}
+
+template <class K, class H, template <class> class R, class C>
+typename split_ordered_hash_set<K, H, R, C>::queue_item_ptr
+split_ordered_hash_set<K, H, R, C>::get_bucket(reclamation_handle_type& h,
+                                               uint64_t                 hash)
+{
+    size_t log = _log_capacity.load(memo::acquire);
+    if (!log) return get_dummy(h, 0);
+
+    size_t prefix = fastrange64(size_t(1) << log, hash);
+    return get_dummy(h, reverse_bits(prefix) >> (64 - log));
+}
+
+template <class K, class H, template <class> class R, class C>
+typename split_ordered_hash_set<K, H, R, C>::queue_item_ptr
+split_ordered_hash_set<K, H, R, C>::get_dummy(reclamation_handle_type& h,
+                                              size_t                   index)
+{
+    auto dummy = directory_slot(index).load(memo::acquire);
+    if (dummy) return dummy;
+    return initialize_dummy(h, index);
+}
+
+// dummies are never removed, therefore, we can keep raw pointers to them
+template <class K, class H, template <class> class R, class C>
+typename split_ordered_hash_set<K, H, R, C>::queue_item_ptr
+split_ordered_hash_set<K, H, R, C>::initialize_dummy(reclamation_handle_type& h,
+                                                     size_t index)
+{
+    queue_item_ptr parent = nullptr;
+    if (index) parent = get_dummy(h, index ^ std::bit_floor(index));
+
+    auto result =
+        _list.insert(h, parent, entry_type{reverse_bits(index), true, K()});
+    queue_item_ptr dummy = result.first.item();
+    directory_slot(index).store(dummy, memo::release);
+    return dummy;
+}
+
+// segment s > 0 contains the indices [2^(s-1), 2^s), segment 0 contains 0
+template <class K, class H, template <class> class R, class C>
+typename split_ordered_hash_set<K, H, R, C>::segment_type&
+split_ordered_hash_set<K, H, R, C>::directory_slot(size_t index)
+{
+    size_t s      = std::bit_width(index);
+    size_t offset = (s) ? index - (size_t(1) << (s - 1)) : 0;
+    size_t length = (s) ? size_t(1) << (s - 1) : 1;
+
+    auto segment = _segments[s].load(memo::acquire);
+    if (segment) return segment[offset];
+
+    auto nsegment = new segment_type[length];
+    for (size_t i = 0; i < length; ++i)
+        nsegment[i].store(nullptr, memo::relaxed);
+    if (_segments[s].compare_exchange_strong(segment, nsegment, memo::acq_rel))
+        return nsegment[offset];
+    delete[] nsegment;
+    return segment[offset];
+}
+
+template <class K, class H, template <class> class R, class C>
+void split_ordered_hash_set<K, H, R, C>::grow(size_t size)
+{
+    size_t log = _log_capacity.load(memo::acquire);
+    if (log >= _max_log || size <= (_max_load_factor << log)) return;
+    _log_capacity.compare_exchange_strong(log, log + 1, memo::acq_rel);
+}
+
+} // namespace utils_tm
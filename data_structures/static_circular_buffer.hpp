@@ -0,0 +1,477 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace utils_tm
+{
+
+// circular_buffer with a fixed capacity, the elements are stored inline
+// (i.e. on the stack, or within the surrounding object).  The capacity is N
+// rounded up to the next power of two.  Since the buffer cannot grow, pushes
+// return false (without inserting) once the buffer is full.
+//
+// The offsets are allowed to wrap around (2^64 is a multiple of the
+// capacity), thus, pushing to the front is as cheap as pushing to the back.
+template <class T, size_t N>
+class static_circular_buffer
+{
+  private:
+    static_assert(N > 0, "static_circular_buffer needs a capacity");
+    static constexpr size_t _capacity = std::bit_ceil(N);
+    static constexpr size_t _bitmask  = _capacity - 1;
+
+  public:
+    using this_type  = static_circular_buffer<T, N>;
+    using value_type = T;
+    using pointer    = T*;
+
+    static_circular_buffer() : _start(0), _end(0) {}
+    static_circular_buffer(const static_circular_buffer& other);
+    static_circular_buffer& operator=(const static_circular_buffer& other);
+    static_circular_buffer(static_circular_buffer&& other) noexcept;
+    static_circular_buffer& operator=(static_circular_buffer&& other) noexcept;
+    ~static_circular_buffer();
+
+    inline bool push_back(const T& e);
+    inline bool push_front(const T& e);
+    template <class... Args>
+    inline bool emplace_back(Args&&... args);
+    template <class... Args>
+    inline bool emplace_front(Args&&... args);
+
+    inline std::optional<T> pop_back();
+    inline std::optional<T> pop_front();
+
+    // appends until the buffer is full, returns the number of new elements
+    template <class InputIt>
+    inline size_t append(InputIt first, InputIt last);
+    // moves up to n elements from the front to out, returns their number
+    template <class OutputIt>
+    inline size_t pop_front_n(OutputIt out, size_t n);
+
+    // the contents in order, the second span is only non-empty if the
+    // contents wrap around the end of the underlying array
+    inline std::pair<std::span<T>, std::span<T>>             as_spans();
+    inline std::pair<std::span<const T>, std::span<const T>> as_spans() const;
+
+    size_t                  size() const { return _end - _start; }
+    static constexpr size_t capacity() { return _capacity; }
+    bool                    full() const { return size() == _capacity; }
+    void                    clear();
+
+    template <bool is_const>
+    class iterator_base
+    {
+      private:
+        using this_type = iterator_base<is_const>;
+        using buffer_type =
+            typename std::conditional<is_const,
+                                      const static_circular_buffer,
+                                      static_circular_buffer>::type;
+        friend static_circular_buffer;
+
+        buffer_type* _circular;
+        size_t       _off;
+
+      public:
+        using difference_type = std::ptrdiff_t;
+        using value_type =
+            typename std::conditional<is_const, const T, T>::type;
+        using reference         = value_type&;
+        using pointer           = value_type*;
+        using iterator_category = std::random_access_iterator_tag;
+
+        iterator_base(buffer_type* buffer, size_t offset)
+            : _circular(buffer), _off(offset)
+        {
+        }
+        iterator_base(const iterator_base& other)            = default;
+        iterator_base& operator=(const iterator_base& other) = default;
+        ~iterator_base()                                     = default;
+
+        inline reference operator*() const;
+        inline pointer   operator->() const;
+        inline reference operator[](difference_type d) const;
+
+        inline iterator_base&  operator+=(difference_type rhs);
+        inline iterator_base&  operator-=(difference_type rhs);
+        inline iterator_base&  operator++();
+        inline iterator_base&  operator--();
+        inline iterator_base   operator+(difference_type rhs) const;
+        inline iterator_base   operator-(difference_type rhs) const;
+        inline difference_type operator-(const iterator_base& rhs) const;
+
+        inline bool operator==(const iterator_base& other) const;
+        inline bool operator!=(const iterator_base& other) const;
+        inline bool operator<(const iterator_base& other) const;
+        inline bool operator>(const iterator_base& other) const;
+        inline bool operator<=(const iterator_base& other) const;
+        inline bool operator>=(const iterator_base& other) const;
+    };
+
+    using iterator       = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+
+    inline iterator       begin() { return iterator(this, _start); }
+    inline const_iterator begin() const { return const_iterator(this, _start); }
+    inline const_iterator cbegin() const
+    {
+        return const_iterator(this, _start);
+    }
+    inline iterator       end() { return iterator(this, _end); }
+    inline const_iterator end() const { return const_iterator(this, _end); }
+    inline const_iterator cend() const { return const_iterator(this, _end); }
+
+  private:
+    size_t _start;
+    size_t _end;
+    union
+    {
+        T _buffer[_capacity];
+    };
+
+    static inline size_t mod(size_t i) { return i & _bitmask; }
+    inline T*            slot(size_t i) { return &_buffer[mod(i)]; }
+    inline const T*      slot(size_t i) const { return &_buffer[mod(i)]; }
+    static inline void   destroy(T* first, T* last);
+};
+
+
+
+
+// CTORS AND DTOR !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, size_t N>
+static_circular_buffer<T, N>::static_circular_buffer(
+    const static_circular_buffer& other)
+    : _start(0), _end(0)
+{
+    for (const auto& e : other) emplace_back(e);
+}
+
+template <class T, size_t N>
+static_circular_buffer<T, N>&
+static_circular_buffer<T, N>::operator=(const static_circular_buffer& other)
+{
+    if (&other == this) return *this;
+
+    this->~this_type();
+    new (this) static_circular_buffer(other);
+    return *this;
+}
+
+// the storage is inline -> elements are moved one by one
+template <class T, size_t N>
+static_circular_buffer<T, N>::static_circular_buffer(
+    static_circular_buffer&& other) noexcept
+    : _start(0), _end(0)
+{
+    for (auto& e : other) emplace_back(std::move(e));
+    other.clear();
+}
+
+template <class T, size_t N>
+static_circular_buffer<T, N>&
+static_circular_buffer<T, N>::operator=(static_circular_buffer&& other) noexcept
+{
+    if (&other == this) return *this;
+
+    this->~this_type();
+    new (this) static_circular_buffer(std::move(other));
+    return *this;
+}
+
+template <class T, size_t N>
+static_circular_buffer<T, N>::~static_circular_buffer()
+{
+    clear();
+}
+
+
+
+
+// MAIN FUNCTIONALITY !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, size_t N>
+bool static_circular_buffer<T, N>::push_back(const T& e)
+{
+    return emplace_back(e);
+}
+
+template <class T, size_t N>
+bool static_circular_buffer<T, N>::push_front(const T& e)
+{
+    return emplace_front(e);
+}
+
+template <class T, size_t N>
+template <class... Args>
+bool static_circular_buffer<T, N>::emplace_back(Args&&... args)
+{
+    if (full()) return false;
+
+    new (slot(_end)) T(std::forward<Args>(args)...);
+    ++_end;
+    return true;
+}
+
+template <class T, size_t N>
+template <class... Args>
+bool static_circular_buffer<T, N>::emplace_front(Args&&... args)
+{
+    if (full()) return false;
+
+    new (slot(_start - 1)) T(std::forward<Args>(args)...);
+    --_start;
+    return true;
+}
+
+template <class T, size_t N>
+std::optional<T> static_circular_buffer<T, N>::pop_back()
+{
+    if (_start == _end) { return {}; }
+
+    --_end;
+    auto result = std::make_optional(std::move(*slot(_end)));
+    slot(_end)->~T();
+    return result;
+}
+
+template <class T, size_t N>
+std::optional<T> static_circular_buffer<T, N>::pop_front()
+{
+    if (_start == _end) { return {}; }
+
+    auto result = std::make_optional(std::move(*slot(_start)));
+    slot(_start)->~T();
+    ++_start;
+    return result;
+}
+
+template <class T, size_t N>
+template <class InputIt>
+size_t static_circular_buffer<T, N>::append(InputIt first, InputIt last)
+{
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>)
+    {
+        size_t n = 0;
+        for (; first != last && emplace_back(*first); ++first) ++n;
+        return n;
+    }
+    else
+    {
+        size_t n = std::min<size_t>(std::distance(first, last),
+                                    _capacity - size());
+
+        // fill the free space behind _end, then the free space at the front
+        size_t pos   = mod(_end);
+        size_t chunk = std::min(n, _capacity - pos);
+        for (size_t i = 0; i < chunk; ++i, ++first)
+            new (&_buffer[pos + i]) T(*first);
+        for (size_t i = 0; i < n - chunk; ++i, ++first)
+            new (&_buffer[i]) T(*first);
+        _end += n;
+        return n;
+    }
+}
+
+template <class T, size_t N>
+template <class OutputIt>
+size_t static_circular_buffer<T, N>::pop_front_n(OutputIt out, size_t n)
+{
+    auto [first, second] = as_spans();
+    size_t k             = std::min(n, size());
+    size_t k0            = std::min(k, first.size());
+
+    out = std::move(first.data(), first.data() + k0, out);
+    destroy(first.data(), first.data() + k0);
+    std::move(second.data(), second.data() + (k - k0), out);
+    destroy(second.data(), second.data() + (k - k0));
+    _start += k;
+    return k;
+}
+
+template <class T, size_t N>
+std::pair<std::span<T>, std::span<T>> static_circular_buffer<T, N>::as_spans()
+{
+    size_t pos   = mod(_start);
+    size_t chunk = std::min(size(), _capacity - pos);
+    return std::make_pair(std::span<T>(_buffer + pos, chunk),
+                          std::span<T>(_buffer, size() - chunk));
+}
+
+template <class T, size_t N>
+std::pair<std::span<const T>, std::span<const T>>
+static_circular_buffer<T, N>::as_spans() const
+{
+    size_t pos   = mod(_start);
+    size_t chunk = std::min(size(), _capacity - pos);
+    return std::make_pair(std::span<const T>(_buffer + pos, chunk),
+                          std::span<const T>(_buffer, size() - chunk));
+}
+
+template <class T, size_t N>
+void static_circular_buffer<T, N>::clear()
+{
+    auto [first, second] = as_spans();
+    destroy(first.data(), first.data() + first.size());
+    destroy(second.data(), second.data() + second.size());
+    _start = _end = 0;
+}
+
+
+// HELPER FUNCTIONS !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, size_t N>
+void static_circular_buffer<T, N>::destroy(T* first, T* last)
+{
+    if constexpr (std::is_trivially_destructible_v<T>) return;
+    for (; first != last; ++first) first->~T();
+}
+
+
+// ITERATOR STUFF !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>::reference
+static_circular_buffer<T, N>::iterator_base<b>::operator*() const
+{
+    return *_circular->slot(_off);
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>::pointer
+static_circular_buffer<T, N>::iterator_base<b>::operator->() const
+{
+    return _circular->slot(_off);
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>::reference
+static_circular_buffer<T, N>::iterator_base<b>::operator[](
+    difference_type d) const
+{
+    return *_circular->slot(_off + d);
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>&
+static_circular_buffer<T, N>::iterator_base<b>::operator+=(difference_type rhs)
+{
+    _off += rhs;
+    return *this;
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>&
+static_circular_buffer<T, N>::iterator_base<b>::operator-=(difference_type rhs)
+{
+    _off -= rhs;
+    return *this;
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>&
+static_circular_buffer<T, N>::iterator_base<b>::operator++()
+{
+    ++_off;
+    return *this;
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>&
+static_circular_buffer<T, N>::iterator_base<b>::operator--()
+{
+    --_off;
+    return *this;
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>
+static_circular_buffer<T, N>::iterator_base<b>::operator+(
+    difference_type rhs) const
+{
+    return iterator_base(_circular, _off + rhs);
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<b>
+static_circular_buffer<T, N>::iterator_base<b>::operator-(
+    difference_type rhs) const
+{
+    return iterator_base(_circular, _off - rhs);
+}
+
+template <class T, size_t N>
+template <bool b>
+typename static_circular_buffer<T, N>::template iterator_base<
+    b>::difference_type
+static_circular_buffer<T, N>::iterator_base<b>::operator-(
+    const iterator_base& rhs) const
+{
+    return difference_type(_off - rhs._off);
+}
+
+template <class T, size_t N>
+template <bool b>
+bool static_circular_buffer<T, N>::iterator_base<b>::operator==(
+    const iterator_base& other) const
+{
+    return (_circular == other._circular) && (_off == other._off);
+}
+
+template <class T, size_t N>
+template <bool b>
+bool static_circular_buffer<T, N>::iterator_base<b>::operator!=(
+    const iterator_base& other) const
+{
+    return (_circular != other._circular) || (_off != other._off);
+}
+
+// offsets may wrap around, therefore, they are compared relative to _start
+template <class T, size_t N>
+template <bool b>
+bool static_circular_buffer<T, N>::iterator_base<b>::operator<(
+    const iterator_base& other) const
+{
+    return _off - _circular->_start < other._off - _circular->_start;
+}
+
+template <class T, size_t N>
+template <bool b>
+bool static_circular_buffer<T, N>::iterator_base<b>::operator>(
+    const iterator_base& other) const
+{
+    return other < *this;
+}
+
+template <class T, size_t N>
+template <bool b>
+bool static_circular_buffer<T, N>::iterator_base<b>::operator<=(
+    const iterator_base& other) const
+{
+    return !(other < *this);
+}
+
+template <class T, size_t N>
+template <bool b>
+bool static_circular_buffer<T, N>::iterator_base<b>::operator>=(
+    const iterator_base& other) const
+{
+    return !(*this < other);
+}
+
+} // namespace utils_tm
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "../concurrency/memory_order.hpp"
+
+namespace utils_tm
+{
+
+// Work-stealing deque (Chase and Lev, with the memory orders of Le et al.).
+// The deque is owned by one thread, which pushes and pops at the bottom
+// (LIFO), all other threads can steal elements from the top (FIFO).  The
+// elements are stored in a circular array with power of two capacity (like
+// circular_buffer), when it is full, the owner copies the contents into an
+// array of twice the size.
+//
+// Thieves might still read from a replaced array, therefore, replaced arrays
+// are kept until the deque is destroyed (at most as much memory as the
+// current array).  Elements are read before they are claimed, thus, T has to
+// be trivially copyable (e.g. a pointer to a task).
+template <class T, class Allocator = std::allocator<T>>
+class work_stealing_deque
+{
+  private:
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "work_stealing_deque needs trivially copyable elements");
+
+  public:
+    using this_type  = work_stealing_deque<T, Allocator>;
+    using memo       = concurrency_tm::standard_memory_order_policy;
+    using value_type = T;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::rebind_alloc<std::atomic<T>>;
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+  private:
+    struct array_type
+    {
+        size_t                         bitmask;
+        typename alloc_traits::pointer buffer;
+        array_type*                    previous;
+
+        inline T get(int64_t i) const
+        {
+            return buffer[size_t(i) & bitmask].load(memo::relaxed);
+        }
+        inline void put(int64_t i, T e)
+        {
+            buffer[size_t(i) & bitmask].store(e, memo::relaxed);
+        }
+    };
+
+    [[no_unique_address]] allocator_type _allocator;
+    alignas(64) std::atomic<int64_t> _top;
+    alignas(64) std::atomic<int64_t> _bottom;
+    std::atomic<array_type*>         _array;
+
+  public:
+    explicit work_stealing_deque(size_t         capacity = 64,
+                                 allocator_type alloc    = {});
+    work_stealing_deque(const work_stealing_deque&)            = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+    ~work_stealing_deque();
+
+    // only the owner may push and pop
+    inline void             push(T e);
+    inline std::optional<T> pop();
+    // any thread, returns nullopt if the deque is empty, or the top element
+    // was taken concurrently (i.e. the deque might not be empty)
+    inline std::optional<T> steal();
+
+    // approximate if used concurrently
+    inline size_t  size() const;
+    inline bool    empty() const { return size() == 0; }
+    inline size_t  capacity() const;
+    allocator_type get_allocator() const { return _allocator; }
+
+  private:
+    inline array_type* create_array(size_t capacity, array_type* previous);
+    inline array_type* grow(array_type* array, int64_t top, int64_t bottom);
+};
+
+
+
+
+// CTORS AND DTOR !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, class A>
+work_stealing_deque<T, A>::work_stealing_deque(size_t         capacity,
+                                               allocator_type alloc)
+    : _allocator(alloc), _top(0), _bottom(0)
+{
+    size_t tcap = 1;
+    while (tcap < capacity) tcap <<= 1;
+    _array.store(create_array(tcap, nullptr), memo::relaxed);
+}
+
+// no concurrent operations allowed
+template <class T, class A>
+work_stealing_deque<T, A>::~work_stealing_deque()
+{
+    auto array = _array.load(memo::relaxed);
+    while (array)
+    {
+        auto temp = array->previous;
+        for (size_t i = 0; i <= array->bitmask; ++i)
+            alloc_traits::destroy(_allocator, array->buffer + i);
+        alloc_traits::deallocate(_allocator, array->buffer, array->bitmask + 1);
+        delete array;
+        array = temp;
+    }
+}
+
+
+
+
+// MAIN FUNCTIONALITY !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, class A>
+void work_stealing_deque<T, A>::push(T e)
+{
+    int64_t b     = _bottom.load(memo::relaxed);
+    int64_t t     = _top.load(memo::acquire);
+    auto    array = _array.load(memo::relaxed);
+
+    if (b - t > int64_t(array->bitmask)) array = grow(array, t, b);
+
+    array->put(b, e);
+    std::atomic_thread_fence(memo::release);
+    _bottom.store(b + 1, memo::relaxed);
+}
+
+template <class T, class A>
+std::optional<T> work_stealing_deque<T, A>::pop()
+{
+    int64_t b     = _bottom.load(memo::relaxed) - 1;
+    auto    array = _array.load(memo::relaxed);
+    _bottom.store(b, memo::relaxed);
+    // the reservation of the bottom element has to be visible to thieves
+    // before we look at the top
+    std::atomic_thread_fence(memo::seq_cst);
+    int64_t t = _top.load(memo::relaxed);
+
+    if (t > b)
+    {
+        // the deque was empty
+        _bottom.store(b + 1, memo::relaxed);
+        return {};
+    }
+
+    T result = array->get(b);
+    if (t < b) return result;
+
+    // last element, race against the thieves
+    bool success =
+        _top.compare_exchange_strong(t, t + 1, memo::seq_cst, memo::relaxed);
+    _bottom.store(b + 1, memo::relaxed);
+    if (!success) return {};
+    return result;
+}
+
+template <class T, class A>
+std::optional<T> work_stealing_deque<T, A>::steal()
+{
+    int64_t t = _top.load(memo::acquire);
+    std::atomic_thread_fence(memo::seq_cst);
+    int64_t b = _bottom.load(memo::acquire);
+
+    if (t >= b) return {};
+
+    auto array  = _array.load(memo::acquire);
+    T    result = array->get(t);
+    if (!_top.compare_exchange_strong(t, t + 1, memo::seq_cst, memo::relaxed))
+        return {};
+    return result;
+}
+
+template <class T, class A>
+size_t work_stealing_deque<T, A>::size() const
+{
+    int64_t b = _bottom.load(memo::acquire);
+    int64_t t = _top.load(memo::acquire);
+    return (b > t) ? size_t(b - t) : 0;
+}
+
+template <class T, class A>
+size_t work_stealing_deque<T, A>::capacity() const
+{
+    return _array.load(memo::acquire)->bitmask + 1;
+}
+
+
+
+
+// HELPER FUNCTIONS !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+template <class T, class A>
+typename work_stealing_deque<T, A>::array_type*
+work_stealing_deque<T, A>::create_array(size_t capacity, array_type* previous)
+{
+    auto buffer = alloc_traits::allocate(_allocator, capacity);
+    for (size_t i = 0; i < capacity; ++i)
+        alloc_traits::construct(_allocator, buffer + i, T());
+    return new array_type{capacity - 1, buffer, previous};
+}
+
+// only called by the owner, elements keep their indices (only the masking
+// changes), thus, thieves can continue on either array
+template <class T, class A>
+typename work_stealing_deque<T, A>::array_type*
+work_stealing_deque<T, A>::grow(array_type* array, int64_t top, int64_t bottom)
+{
+    auto narray = create_array(2 * (array->bitmask + 1), array);
+    for (int64_t i = top; i < bottom; ++i) narray->put(i, array->get(i));
+    _array.store(narray, memo::release);
+    return narray;
+}
+
+} // namespace utils_tm
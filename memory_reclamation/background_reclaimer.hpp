@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+
+#include "../concurrency/memory_order.hpp"
+#include "../data_structures/many_producer_single_consumer_buffer.hpp"
+#include "../debug.hpp"
+
+namespace utils_tm
+{
+namespace reclamation_tm
+{
+
+// Moves the destructor calls of a reclamation manager onto a dedicated
+// thread.  The manager is instantiated with background_destructor<T>, which
+// pushes reclaimable pointers into the many_producer_single_consumer_buffer
+// of the reclaimer, instead of deleting them on the calling thread.  The
+// reclaimer thread pulls everything that is buffered and deletes it in one
+// batch (using manager.delete_raw).  The buffered pointers are type-erased,
+// thus, the same reclaimer class works for the managers of all containers
+// (rebind keeps the destructor, i.e., a container rebinds
+// background_destructor<T> to background_destructor<node_type>).
+//
+// One reclaimer serves exactly one manager: the one given to start (starting
+// it again with a different manager fails).  Each push carries the element
+// type of its destructor, elements whose type does not match the manager are
+// deleted directly (this is reported in debug mode).  Different managers
+// need different reclaimers.
+//
+// Whenever the reclaimer is not running, or its buffer is full, the
+// background_destructor deletes the element directly (like
+// default_destructor).
+//
+//     using manager_type = hazard_manager<T, background_destructor<T>>;
+//     // or typename container::reclamation_manager_type
+//     background_reclaimer reclaimer;
+//     manager_type manager{typename manager_type::destructor_type(reclaimer)};
+//     reclaimer.start(manager);
+//     ... // threads use the manager
+//     reclaimer.stop(); // before the manager is destroyed
+//
+// stop waits for concurrent pushes, afterwards all elements are either
+// deleted by the reclaimer or directly by the pushing thread.  It has to be
+// called before the manager is destroyed (the destructor of the manager then
+// deletes the remaining elements directly).
+class background_reclaimer
+{
+  private:
+    using memo        = concurrency_tm::standard_memory_order_policy;
+    using buffer_type = auto_many_producer_single_consumer_buffer<void*>;
+    using delete_fn   = void (*)(void*, void*);
+
+  public:
+    background_reclaimer(size_t capacity     = 1024,
+                         size_t max_capacity = 1 << 16)
+        : _buffer(capacity, max_capacity), _running(false), _producers(0),
+          _manager(nullptr), _type(nullptr), _delete(nullptr)
+    {
+    }
+    background_reclaimer(const background_reclaimer&)            = delete;
+    background_reclaimer& operator=(const background_reclaimer&) = delete;
+    ~background_reclaimer() { stop(); }
+
+    template <class Manager>
+    void start(Manager& manager);
+    void stop();
+
+    // called by the background_destructor (from any thread), returns false
+    // if the element has to be deleted by the caller
+    template <class T>
+    inline bool push(T* ptr);
+
+    bool is_running() const { return _running.load(memo::acquire); }
+
+  private:
+    buffer_type      _buffer;
+    std::atomic_bool _running;
+    std::atomic_int  _producers; // pushes that saw the reclaimer running
+    void*            _manager;
+    const void*      _type; // type tag of the manager's elements
+    delete_fn        _delete;
+    std::thread      _thread;
+
+    // one unique address per element type
+    template <class T>
+    struct type_tag
+    {
+        static constexpr char id = 0;
+    };
+
+    size_t drain_batch();
+    void   run();
+};
+
+template <class T>
+class background_destructor
+{
+  public:
+    template <class U>
+    struct rebind
+    {
+        using other = background_destructor<U>;
+    };
+
+    background_destructor() : _reclaimer(nullptr) {}
+    background_destructor(background_reclaimer& reclaimer)
+        : _reclaimer(&reclaimer)
+    {
+    }
+
+    template <class ReclHandle>
+    void destroy(ReclHandle& h, T* ptr) const
+    {
+        if (!_reclaimer || !_reclaimer->push(ptr)) h.delete_raw(ptr);
+    }
+
+  private:
+    background_reclaimer* _reclaimer;
+};
+
+
+
+
+// MAIN FUNCTIONALITY **********************************************************
+template <class Manager>
+void background_reclaimer::start(Manager& manager)
+{
+    using pointer_type = typename Manager::pointer_type;
+    using element_type = std::remove_pointer_t<pointer_type>;
+
+    if (_running.load(memo::acquire)) return;
+    if (_manager && _manager != &manager)
+    {
+        debug_tm::if_debug_critical(
+            "background_reclaimer: started with a second manager");
+        return;
+    }
+
+    _manager = &manager;
+    _type    = &type_tag<element_type>::id;
+    _delete  = [](void* mngr, void* ptr) {
+        static_cast<Manager*>(mngr)->delete_raw(static_cast<pointer_type>(ptr));
+    };
+    _running.store(true, memo::release);
+    _thread = std::thread([this]() { run(); });
+}
+
+// pushes that start after the exchange fail (their elements are deleted
+// directly), pushes that saw the reclaimer running are waited for
+inline void background_reclaimer::stop()
+{
+    if (!_running.exchange(false, memo::seq_cst)) return;
+    while (_producers.load(memo::seq_cst))
+    { /* wait for concurrent pushes */
+    }
+    _thread.join();
+
+    // the reclaimer thread is finished, i.e., this thread is the new consumer
+    while (drain_batch())
+    { /* delete the remaining elements */
+    }
+}
+
+template <class T>
+bool background_reclaimer::push(T* ptr)
+{
+    // pairs with stop (running is reset before producers is read)
+    _producers.fetch_add(1, memo::seq_cst);
+    bool result = _running.load(memo::seq_cst);
+    if (result && _type != &type_tag<T>::id)
+    {
+        debug_tm::if_debug_critical(
+            "background_reclaimer: element type does not match the manager");
+        result = false;
+    }
+    result = result && _buffer.push_back(ptr);
+    _producers.fetch_sub(1, memo::release);
+    return result;
+}
+
+
+
+
+// HELPER FUNCTIONS ************************************************************
+inline size_t background_reclaimer::drain_batch()
+{
+    auto range = _buffer.pull_all();
+    for (void* ptr : range) _delete(_manager, ptr);
+    return range.size();
+}
+
+inline void background_reclaimer::run()
+{
+    while (_running.load(memo::acquire))
+    {
+        if (!drain_batch())
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+} // namespace reclamation_tm
+} // namespace utils_tm
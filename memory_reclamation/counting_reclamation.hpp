@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -14,6 +16,7 @@
 
 #include "default_destructor.hpp"
 #include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
 
 namespace utils_tm
 {
@@ -22,10 +25,30 @@ namespace reclamation_tm
 
 namespace ctm = concurrency_tm;
 
+// Each element has a reference counter, that is incremented by protect and
+// decremented by unprotect (the last unprotect of a retired element deletes
+// it).
+//
+// cachedProtections > 0 enables differential reference counting: each handle
+// caches the elements it currently protects together with a local counter.
+// Only the first protection of an element (by this handle) increments the
+// shared counter, and only the last unprotect decrements it (i.e. the local
+// delta is merged on release).  Thus, repeated protections of hot elements
+// (e.g. the head of a list) do not need read-modify-writes.  If all cache
+// entries are taken, the shared counter is used directly.
+//
+// Memory is type-stable, i.e., deleted elements are only destroyed (T::~T)
+// and their memory is recycled by create_pointer (it is only returned to
+// the allocator once the manager is destroyed).  Each handle keeps up to
+// handlePoolSize recycled elements in a local Queue, elements beyond that
+// are spilled (in batches) to a shared pool, from which handles refill
+// their local queue once it is empty.
 template <class T,
           class Destructor             = default_destructor<T>,
           class Allocator              = std::allocator<T>,
-          template <class> class Queue = circular_buffer>
+          template <class> class Queue = circular_buffer,
+          size_t cachedProtections     = 0,
+          size_t handlePoolSize        = 64>
 class counting_manager
 {
   private:
@@ -55,7 +78,12 @@ class counting_manager
     };
 
   public:
-    using this_type       = counting_manager<T, Destructor, Allocator, Queue>;
+    using this_type       = counting_manager<T,
+                                           Destructor,
+                                           Allocator,
+                                           Queue,
+                                           cachedProtections,
+                                           handlePoolSize>;
     using destructor_type = Destructor;
     using internal_type   = _counted_object;
     using allocator_type =
@@ -67,12 +95,14 @@ class counting_manager
     using protected_type      = internal_type;
 
     template <class lT                  = T,
-              class lD                  = default_destructor<lT>,
+              class lD                  = rebind_destructor<Destructor, lT>,
               class lA                  = Allocator,
-              template <class> class lQ = Queue>
+              template <class> class lQ = Queue,
+              size_t lcP                = cachedProtections,
+              size_t lhP                = handlePoolSize>
     struct rebind
     {
-        using other = counting_manager<lT, lD, lA, lQ>;
+        using other = counting_manager<lT, lD, lA, lQ, lcP, lhP>;
     };
 
 
@@ -91,7 +121,12 @@ class counting_manager
     class handle_type
     {
       private:
-        using parent_type   = counting_manager<T, Destructor, Allocator, Queue>;
+        using parent_type   = counting_manager<T,
+                                               Destructor,
+                                               Allocator,
+                                               Queue,
+                                               cachedProtections,
+                                               handlePoolSize>;
         using this_type     = handle_type;
         using internal_type = typename parent_type::internal_type;
 
@@ -103,18 +138,28 @@ class counting_manager
         handle_type(parent_type& parent) : n(0), _parent(parent) {}
         handle_type(const handle_type&)                      = delete;
         handle_type& operator=(const handle_type&)           = delete;
-        handle_type(handle_type&& other) noexcept            = default;
+        handle_type(handle_type&& other) noexcept;
         handle_type& operator=(handle_type&& other) noexcept = default;
-        ~handle_type()                                       = default;
+        ~handle_type();
 
+        // protections currently held by this handle (protect - unprotect)
         size_t n;
 
       private:
-        parent_type& _parent;
+        // a cached element is protected once in its shared counter
+        struct cached_protection
+        {
+            internal_type* ptr   = nullptr;
+            size_t         count = 0;
+        };
+
+        parent_type&                                     _parent;
+        std::array<cached_protection, cachedProtections> _cache;
+        queue_type                                       _pool;
 
       public:
         template <class... Args>
-        inline T* create_pointer(Args&&... arg) const;
+        inline T* create_pointer(Args&&... arg);
 
         inline T*         protect(const atomic_pointer_type& ptr);
         inline void       protect_raw(pointer_type ptr);
@@ -131,35 +176,52 @@ class counting_manager
         void print() const;
 
       private:
-        inline internal_type* get_iptr(pointer_type ptr) const;
-        inline void           internal_delete(internal_type* iptr);
+        inline internal_type*     get_iptr(pointer_type ptr) const;
+        inline void               internal_delete(internal_type* iptr);
+        inline cached_protection* find_cached(internal_type* iptr);
+        inline void               insert_cached(internal_type* iptr);
+        inline bool               release_cached(internal_type* iptr);
+        inline void               refill_pool();
+        inline void               spill_pool(internal_type* iptr);
     };
 
-    handle_type    get_handle() { return handle_type(*this); }
-    void           delete_raw(pointer_type ptr);
-    allocator_type get_allocator() const { return _allocator; }
+    handle_type       get_handle() { return handle_type(*this); }
+    void              delete_raw(pointer_type ptr);
+    allocator_type    get_allocator() const { return _allocator; }
+    reclamation_stats get_stats() const;
 
   private:
     [[no_unique_address]] destructor_type _destructor;
     [[no_unique_address]] allocator_type  _allocator;
+    [[no_unique_address]] stats_counter   _stats;
     std::mutex                            _freelist_mutex;
     queue_type                            _freelist;
 };
 
 
-template <class T, class D, class A, template <class> class Q>
-counting_manager<T, D, A, Q>::counting_manager(counting_manager&& other,
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+counting_manager<T, D, A, Q, cp, hp>::counting_manager(counting_manager&& other,
                                                allocator_type     alloc)
     : _destructor(std::move(other._destructor)), _allocator(alloc),
-      _freelist_mutex(), _freelist()
+      _stats(other._stats), _freelist_mutex(), _freelist()
 {
     std::lock_guard<std::mutex> guard(other._freelist_mutex);
     _freelist = std::move(other._freelist);
 }
 
-template <class T, class D, class A, template <class> class Q>
-counting_manager<T, D, A, Q>&
-counting_manager<T, D, A, Q>::operator=(counting_manager&& other)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+counting_manager<T, D, A, Q, cp, hp>&
+counting_manager<T, D, A, Q, cp, hp>::operator=(counting_manager&& other)
 {
     if (&other == this) return *this;
     this->~counting_manager();
@@ -167,8 +229,13 @@ counting_manager<T, D, A, Q>::operator=(counting_manager&& other)
     return *this;
 }
 
-template <class T, class D, class A, template <class> class Q>
-counting_manager<T, D, A, Q>::~counting_manager()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+counting_manager<T, D, A, Q, cp, hp>::~counting_manager()
 {
     // no concurrency possible thus no mutex necessary
     // std::lock_guard<std::mutex> guard(_freelist_mutex);
@@ -180,8 +247,13 @@ counting_manager<T, D, A, Q>::~counting_manager()
     }
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::delete_raw(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::delete_raw(pointer_type ptr)
 {
     auto iptr = static_cast<internal_type*>(mark::clear(ptr));
 
@@ -191,41 +263,81 @@ void counting_manager<T, D, A, Q>::delete_raw(pointer_type ptr)
     _freelist.push_back(iptr);
 }
 
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+reclamation_stats counting_manager<T, D, A, Q, cp, hp>::get_stats() const
+{
+    reclamation_stats stats;
+    _stats.add_to(stats);
+    return stats;
+}
+
 
 
 // *** COUNTING_OBJECT *********************************************************
-template <class T, class D, class A, template <class> class Q>
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
 template <class... Args>
-counting_manager<T, D, A, Q>::_counted_object::_counted_object(Args&&... arg)
+counting_manager<T, D, A, Q, cp, hp>::_counted_object::_counted_object(
+    Args&&... arg)
     : T(std::forward<Args>(arg)...), _counter(0)
 {
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::_counted_object::erase()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::_counted_object::erase()
 {
     // this should not use alloc_traits::destroy(_allocator, this)
     // because only the base class object is deleted
     this->T::~T();
 }
 
-template <class T, class D, class A, template <class> class Q>
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
 template <class... Args>
-void counting_manager<T, D, A, Q>::_counted_object::emplace(Args&&... arg)
+void counting_manager<T, D, A, Q, cp, hp>::_counted_object::emplace(
+    Args&&... arg)
 {
     // this should not use alloc_traits::construct(_allocator, ...)
     // because only the base class object is reconstructed
     new (this) T(std::forward<Args>(arg)...);
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::_counted_object::increment_counter()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::_counted_object::increment_counter()
 {
     _counter.fetch_add(1, memo::acquire);
 }
 
-template <class T, class D, class A, template <class> class Q>
-bool counting_manager<T, D, A, Q>::_counted_object::decrement_counter()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+bool counting_manager<T, D, A, Q, cp, hp>::_counted_object::decrement_counter()
 {
     auto temp = _counter.fetch_sub(1, memo::acq_rel);
     debug_tm::if_debug("Warning: in decrement_counter - "
@@ -238,8 +350,13 @@ bool counting_manager<T, D, A, Q>::_counted_object::decrement_counter()
     return (temp == del_flag + 1);
 }
 
-template <class T, class D, class A, template <class> class Q>
-bool counting_manager<T, D, A, Q>::_counted_object::mark_deletion()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+bool counting_manager<T, D, A, Q, cp, hp>::_counted_object::mark_deletion()
 {
     auto temp = _counter.fetch_or(del_flag, memo::acq_rel);
 
@@ -250,21 +367,36 @@ bool counting_manager<T, D, A, Q>::_counted_object::mark_deletion()
     return (temp == 0); // element was unused, and not marked before
 }
 
-template <class T, class D, class A, template <class> class Q>
-bool counting_manager<T, D, A, Q>::_counted_object::is_safe()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+bool counting_manager<T, D, A, Q, cp, hp>::_counted_object::is_safe()
 {
     return !_counter.load(memo::acquire);
 }
 
-template <class T, class D, class A, template <class> class Q>
-bool counting_manager<T, D, A, Q>::_counted_object::reset()
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+bool counting_manager<T, D, A, Q, cp, hp>::_counted_object::reset()
 {
     auto temp = del_flag;
     return _counter.compare_exchange_strong(temp, 0, memo::acq_rel);
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::_counted_object::print() const
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::_counted_object::print() const
 {
     auto temp = _counter.load(memo::acquire);
     out_tm::out() << ((temp & del_flag) ? "d" : "") //
@@ -272,21 +404,55 @@ void counting_manager<T, D, A, Q>::_counted_object::print() const
 }
 
 // *** HANDLE STUFF ************************************************************
+// ***** HANDLE CONSTRUCTORS ***************************************************
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+counting_manager<T, D, A, Q, cp, hp>::handle_type::handle_type(
+    handle_type&& other) noexcept
+    : n(other.n), _parent(other._parent), _cache(other._cache), _pool()
+{
+    // the moved from handle keeps an empty (but valid) pool
+    std::swap(_pool, other._pool);
+}
+
+// recycled elements are returned to the shared pool
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+counting_manager<T, D, A, Q, cp, hp>::handle_type::~handle_type()
+{
+    if (!_pool.size()) return;
+    std::lock_guard<std::mutex> guard(_parent._freelist_mutex);
+    for (auto iptr : _pool) _parent._freelist.push_back(iptr);
+}
+
+
+
 // ***** HANDLE MAIN FUNCTIONALITY *********************************************
-template <class T, class D, class A, template <class> class Q>
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
 template <class... Args>
-T* counting_manager<T, D, A, Q>::handle_type::create_pointer(
-    Args&&... args) const
+T* counting_manager<T, D, A, Q, cp, hp>::handle_type::create_pointer(
+    Args&&... args)
 {
     internal_type* temp = nullptr;
 #ifndef NO_FREELIST
-    { // area for the lock_guard
-        std::lock_guard<std::mutex> guard(_parent._freelist_mutex);
-        auto                        result = _parent._freelist.pop_front();
-        if (result) { temp = result.value(); }
-    }
-    if (temp)
+    if (!_pool.size()) refill_pool();
+    auto result = _pool.pop_front();
+    if (result)
     {
+        temp = result.value();
         temp->emplace(std::forward<Args>(args)...);
         return temp;
     }
@@ -301,13 +467,24 @@ T* counting_manager<T, D, A, Q>::handle_type::create_pointer(
     return temp;
 }
 
-template <class T, class D, class A, template <class> class Q>
-T* counting_manager<T, D, A, Q>::handle_type::protect(
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+T* counting_manager<T, D, A, Q, cp, hp>::handle_type::protect(
     const atomic_pointer_type& ptr)
 {
     ++n;
     auto temp = ptr.load(memo::acquire);
     if (!mark::clear(temp)) return nullptr; // nullptr cannot be protected
+    if (auto c = find_cached(get_iptr(temp)))
+    {
+        // the element is already protected by this handle
+        ++c->count;
+        return temp;
+    }
     get_iptr(temp)->increment_counter();
     auto temp2 = ptr.load(memo::acquire);
     while (temp != temp2)
@@ -319,71 +496,127 @@ T* counting_manager<T, D, A, Q>::handle_type::protect(
         get_iptr(temp)->increment_counter();
         temp2 = ptr.load(memo::acquire);
     }
+    insert_cached(get_iptr(temp));
     return temp;
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::protect_raw(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::protect_raw(
+    pointer_type ptr)
 {
     ++n;
-    get_iptr(ptr)->increment_counter();
+    auto temp = get_iptr(ptr);
+    if (auto c = find_cached(temp))
+    {
+        ++c->count;
+        return;
+    }
+    temp->increment_counter();
+    insert_cached(temp);
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::unprotect(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::unprotect(
+    pointer_type ptr)
 {
     --n;
     auto temp = get_iptr(ptr);
+    if (release_cached(temp)) return;
     if (temp->decrement_counter()) internal_delete(temp);
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::unprotect(
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::unprotect(
     std::vector<pointer_type>& vec)
 {
     n -= vec.size();
     for (auto ptr : vec)
     {
         auto temp = get_iptr(ptr);
+        if (release_cached(temp)) continue;
         if (temp->decrement_counter()) internal_delete(temp);
     }
 }
 
-template <class T, class D, class A, template <class> class Q>
-typename counting_manager<T, D, A, Q>::handle_type::guard_type
-counting_manager<T, D, A, Q>::handle_type::guard(
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+typename counting_manager<T, D, A, Q, cp, hp>::handle_type::guard_type
+counting_manager<T, D, A, Q, cp, hp>::handle_type::guard(
     const atomic_pointer_type& aptr)
 {
     return make_rec_guard(*this, aptr);
 }
 
-template <class T, class D, class A, template <class> class Q>
-typename counting_manager<T, D, A, Q>::handle_type::guard_type
-counting_manager<T, D, A, Q>::handle_type::guard(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+typename counting_manager<T, D, A, Q, cp, hp>::handle_type::guard_type
+counting_manager<T, D, A, Q, cp, hp>::handle_type::guard(pointer_type ptr)
 {
     return make_rec_guard(*this, ptr);
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::safe_delete(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::safe_delete(
+    pointer_type ptr)
 {
     auto temp = get_iptr(ptr);
+    _parent._stats.retire();
     if (temp->mark_deletion()) internal_delete(temp);
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::delete_raw(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::delete_raw(
+    pointer_type ptr)
 {
     auto iptr = get_iptr(ptr);
 
     iptr->internal_type::erase();
 
-    std::lock_guard<std::mutex> guard(_parent._freelist_mutex);
-    _parent._freelist.push_back(iptr);
+    if (_pool.size() < hp) _pool.push_back(iptr);
+    else spill_pool(iptr);
 }
 
-template <class T, class D, class A, template <class> class Q>
-bool counting_manager<T, D, A, Q>::handle_type::is_safe(pointer_type ptr)
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+bool counting_manager<T, D, A, Q, cp, hp>::handle_type::is_safe(
+    pointer_type ptr)
 {
     return get_iptr(ptr)->is_safe();
 }
@@ -392,39 +625,152 @@ bool counting_manager<T, D, A, Q>::handle_type::is_safe(pointer_type ptr)
 
 
 // ***** HANDLE HELPER FUNCTIONS ***********************************************
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::print(pointer_type ptr) const
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::print(
+    pointer_type ptr) const
 {
     get_iptr(ptr)->print();
 }
 
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::print() const
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::print() const
 {
     std::lock_guard<std::mutex> guard(_parent._freelist_mutex);
     out_tm::out() << "* print in counting reclamation strategy "
+                  << _pool.size() << " elements in the local pool, "
                   << _parent._freelist.size() << " elements in the freelist *"
                   << std::endl;
 }
 
 
-template <class T, class D, class A, template <class> class Q>
-typename counting_manager<T, D, A, Q>::handle_type::internal_type*
-counting_manager<T, D, A, Q>::handle_type::get_iptr(pointer_type ptr) const
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+typename counting_manager<T, D, A, Q, cp, hp>::handle_type::internal_type*
+counting_manager<T, D, A, Q, cp, hp>::handle_type::get_iptr(
+    pointer_type ptr) const
 {
     return static_cast<internal_type*>(mark::clear(ptr));
 }
 
-template <class T, class D, class A, template <class> class Q>
-void counting_manager<T, D, A, Q>::handle_type::internal_delete(
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::internal_delete(
     internal_type* ptr)
 {
     if (ptr->reset())
     {
         _parent._destructor.destroy(*this, static_cast<pointer_type>(ptr));
+        _parent._stats.free();
+    }
+}
+
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+typename counting_manager<T, D, A, Q, cp, hp>::handle_type::cached_protection*
+counting_manager<T, D, A, Q, cp, hp>::handle_type::find_cached(
+    internal_type* iptr)
+{
+    for (auto& c : _cache)
+        if (c.ptr == iptr) return &c;
+    return nullptr;
+}
+
+// the shared counter of iptr was just incremented by this handle
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::insert_cached(
+    internal_type* iptr)
+{
+    for (auto& c : _cache)
+    {
+        if (c.ptr) continue;
+        c.ptr   = iptr;
+        c.count = 1;
+        return;
+    }
+}
+
+// returns true if the element stays protected by this handle, i.e., if the
+// shared counter must not be decremented
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+bool counting_manager<T, D, A, Q, cp, hp>::handle_type::release_cached(
+    internal_type* iptr)
+{
+    auto c = find_cached(iptr);
+    if (!c) return false;
+    if (--c->count) return true;
+    c->ptr = nullptr;
+    return false;
+}
+
+// moves a batch of elements from the shared pool into the local pool
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::refill_pool()
+{
+    constexpr size_t batch = std::max<size_t>(hp / 2, 1);
+
+    std::lock_guard<std::mutex> guard(_parent._freelist_mutex);
+    for (size_t i = 0; i < batch; ++i)
+    {
+        auto result = _parent._freelist.pop_front();
+        if (!result) return;
+        _pool.push_back(result.value());
     }
 }
 
+// the local pool is full, iptr and half of the local pool are moved to the
+// shared pool
+template <class T,
+          class D,
+          class A,
+          template <class> class Q,
+          size_t cp,
+          size_t hp>
+void counting_manager<T, D, A, Q, cp, hp>::handle_type::spill_pool(
+    internal_type* iptr)
+{
+    std::lock_guard<std::mutex> guard(_parent._freelist_mutex);
+    _parent._freelist.push_back(iptr);
+    for (size_t i = 0; i < hp / 2; ++i)
+        _parent._freelist.push_back(_pool.pop_front().value());
+}
+
 } // namespace reclamation_tm
 } // namespace utils_tm
@@ -21,5 +21,10 @@ class default_destructor
         h.delete_raw(ptr);
     }
 };
+
+// the destructor of a manager that is rebound to another element type (used
+// as default by the rebind of each manager, to keep custom destructors)
+template <class Destructor, class T>
+using rebind_destructor = typename Destructor::template rebind<T>::other;
 } // namespace reclamation_tm
 } // namespace utils_tm
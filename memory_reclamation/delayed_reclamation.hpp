@@ -10,6 +10,7 @@
 
 #include "default_destructor.hpp"
 #include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
 
 namespace utils_tm
 {
@@ -29,10 +30,12 @@ class delayed_manager
     using atomic_pointer_type = std::atomic<T*>;
     using protected_type      = T;
 
-    template <class lT = T, class lD = default_destructor<T>, class lA = A>
+    template <class lT = T,
+              class lD = rebind_destructor<D, lT>,
+              class lA = A>
     struct rebind
     {
-        using other = delayed_manager<lT, lA>;
+        using other = delayed_manager<lT, lD, lA>;
     };
 
     delayed_manager(const allocator_type& alloc = A()) : _allocator(alloc) {}
@@ -87,9 +90,16 @@ class delayed_manager
 
     [[no_unique_address]] destructor_type _destructor;
     [[no_unique_address]] allocator_type  _allocator;
+    [[no_unique_address]] stats_counter   _stats;
 
-    handle_type get_handle() { return handle_type(*this); }
-    void        delete_raw(pointer_type ptr)
+    handle_type       get_handle() { return handle_type(*this); }
+    reclamation_stats get_stats() const
+    {
+        reclamation_stats stats;
+        _stats.add_to(stats);
+        return stats;
+    }
+    void delete_raw(pointer_type ptr)
     { // delete mark::clear(ptr);
         auto cptr = mark::clear(ptr);
         alloc_traits::destroy(_allocator, cptr);
@@ -104,7 +114,8 @@ class delayed_manager
 template <class T, class D, class A>
 delayed_manager<T, D, A>::delayed_manager(delayed_manager&& other,
                                           allocator_type    alloc)
-    : _destructor(std::move(other._destructor)), _allocator(alloc)
+    : _destructor(std::move(other._destructor)), _allocator(alloc),
+      _stats(other._stats)
 {
 }
 
@@ -117,6 +128,7 @@ delayed_manager<T, D, A>::handle_type::~handle_type()
     { // delete curr;
         _parent._destructor.destroy(*this, curr);
     }
+    _parent._stats.free(_freelist.size());
 }
 
 
@@ -141,6 +153,7 @@ template <class T, class D, class A>
 void delayed_manager<T, D, A>::handle_type::safe_delete(pointer_type ptr)
 {
     _freelist.push_back(mark::clear(ptr));
+    _parent._stats.retire(_freelist.size());
 }
 
 
@@ -0,0 +1,478 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../concurrency/memory_order.hpp"
+#include "../mark_pointer.hpp"
+#include "../output.hpp"
+
+#include "default_destructor.hpp"
+#include "handle_registry.hpp"
+#include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
+
+namespace utils_tm
+{
+namespace reclamation_tm
+{
+
+namespace otm = out_tm;
+
+// Interval-based reclamation (2GE-IBR by Wen et al., similar to hazard eras).
+// There is a global era clock that is advanced every eraFrequency retired
+// elements.  While a handle protects at least one element, it publishes an
+// interval of eras [lower, upper], lower is the era when the first element
+// was protected, upper is extended whenever protect sees a new era.  Thus,
+// protect only publishes (and fences) when the era changed, otherwise, it is
+// a load of the pointer and a load of the era clock.
+//
+// A retired element can be deleted, once its lifetime [birth, retire] does
+// not intersect any published interval.  Since stalled handles only block
+// elements that were alive during their interval, the number of unreclaimed
+// elements stays bounded (like in hazard_manager).
+//
+// The birth era is stored in a header of each element, i.e., elements are
+// allocated as internal_type (derived from T) by create_pointer (like in
+// counting_manager), and only elements created this way can be retired.
+//
+// A handle scans its retired elements once their number reaches its scan
+// threshold.  After each scan, the threshold is set to twice the number of
+// elements that could not be freed (at least 2 * eraFrequency), thus, a
+// stalled handle does not cause a full scan on every retire.
+template <class T,
+          class Destructor         = default_destructor<T>,
+          class Allocator          = std::allocator<T>,
+          size_t handlesPerSegment = 64,
+          size_t eraFrequency      = 64>
+class era_manager
+{
+  private:
+    class _era_object : public T
+    {
+      public:
+        template <class... Args>
+        _era_object(uint64_t birth, Args&&... arg)
+            : T(std::forward<Args>(arg)...), birth_era(birth)
+        {
+        }
+
+        uint64_t birth_era;
+    };
+
+  public:
+    using this_type = era_manager<T,
+                                  Destructor,
+                                  Allocator,
+                                  handlesPerSegment,
+                                  eraFrequency>;
+    using memo            = concurrency_tm::standard_memory_order_policy;
+    using destructor_type = Destructor;
+    using internal_type   = _era_object;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::rebind_alloc<internal_type>;
+    using alloc_traits        = std::allocator_traits<allocator_type>;
+    using pointer_type        = T*;
+    using atomic_pointer_type = std::atomic<T*>;
+    using protected_type      = internal_type;
+
+    template <class lT   = T,
+              class lD   = rebind_destructor<Destructor, lT>,
+              class lA   = Allocator,
+              size_t lhS = handlesPerSegment,
+              size_t leF = eraFrequency>
+    struct rebind
+    {
+        using other = era_manager<lT, lD, lA, lhS, leF>;
+    };
+
+    era_manager(destructor_type&& destructor = {}, allocator_type alloc = {})
+        : _destructor(std::move(destructor)), _allocator(alloc), _era(1)
+    {
+    }
+    era_manager(const era_manager&)             = delete;
+    era_manager& operator=(const era_manager&)  = delete;
+    era_manager(era_manager&& other)            = delete;
+    era_manager& operator=(era_manager&& other) = delete;
+    ~era_manager();
+
+    struct retired_type
+    {
+        pointer_type ptr;
+        uint64_t     birth;
+        uint64_t     retire;
+    };
+
+    // the interval is read by all handles (0 means inactive), everything
+    // else is only used by the current owner
+    struct alignas(64) internal_handle
+    {
+        internal_handle() : _lower(0), _upper(0), _cached_upper(0), _active(0)
+        {
+        }
+
+        std::atomic_uint64_t                _lower;
+        std::atomic_uint64_t                _upper;
+        uint64_t                            _cached_upper;
+        size_t                              _active;
+        size_t                              _retire_counter = 0;
+        size_t                              _scan_threshold = 2 * eraFrequency;
+        std::vector<retired_type>           _retired;
+        [[no_unique_address]] stats_counter _stats;
+    };
+
+    class handle_type
+    {
+      private:
+        using parent_type = era_manager<T,
+                                        Destructor,
+                                        Allocator,
+                                        handlesPerSegment,
+                                        eraFrequency>;
+        using this_type   = handle_type;
+
+      public:
+        using pointer_type        = typename parent_type::pointer_type;
+        using atomic_pointer_type = typename parent_type::atomic_pointer_type;
+        using guard_type          = reclamation_guard<T, this_type>;
+
+        handle_type(parent_type& parent, internal_handle& internal, int id);
+        handle_type(const handle_type&)            = delete;
+        handle_type& operator=(const handle_type&) = delete;
+        // handles should not be moved while other operations are ongoing
+        handle_type(handle_type&& other) noexcept;
+        handle_type& operator=(handle_type&& other) noexcept;
+        ~handle_type();
+
+        template <class... Args>
+        inline T* create_pointer(Args&&... args) const;
+
+        inline T*   protect(const atomic_pointer_type& ptr);
+        inline void protect_raw(pointer_type ptr);
+
+        inline void unprotect(pointer_type ptr);
+        inline void unprotect(std::vector<T*>& vec);
+
+        inline guard_type guard(const atomic_pointer_type& ptr);
+        inline guard_type guard(pointer_type ptr);
+
+        inline void safe_delete(pointer_type ptr);
+        inline void delete_raw(pointer_type ptr);
+        inline bool is_safe(pointer_type ptr);
+
+        void print() const;
+
+      private:
+        inline void begin_interval();
+        inline void end_interval();
+        inline void scan();
+
+        parent_type&     _parent;
+        internal_handle& _internal;
+        int              _id;
+    };
+    friend handle_type;
+    using guard_type = typename handle_type::guard_type;
+
+    handle_type       get_handle();
+    void              delete_raw(pointer_type ptr);
+    reclamation_stats get_stats() const;
+    void              print() const;
+
+  private:
+    [[no_unique_address]] Destructor     _destructor;
+    [[no_unique_address]] allocator_type _allocator;
+
+    alignas(64) std::atomic_uint64_t _era;
+    handle_registry<internal_handle, handlesPerSegment> _handles;
+
+    static inline uint64_t birth_era(const T* ptr);
+    inline bool            conflicts(const retired_type& r) const;
+};
+
+
+
+template <class T, class D, class A, size_t hs, size_t ef>
+era_manager<T, D, A, hs, ef>::~era_manager()
+{
+    auto counter = _handles.max_id();
+    for (int i = counter; i >= 0; --i)
+    {
+        auto temp = _handles.load(i);
+        while (!mark::get_mark<0>(temp))
+        { /* wait for handles to be destroyed */
+            temp = _handles.load(i);
+        }
+    }
+
+    // no handle is left, i.e., all retired elements are unprotected
+    for (int i = counter; i >= 0; --i)
+    {
+        auto internal = mark::clear(_handles.load(i));
+        for (auto& r : internal->_retired) _destructor.destroy(*this, r.ptr);
+        delete internal;
+    }
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+typename era_manager<T, D, A, hs, ef>::handle_type
+era_manager<T, D, A, hs, ef>::get_handle()
+{
+    auto [internal, id] = _handles.acquire();
+    return handle_type(*this, *internal, id);
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::delete_raw(pointer_type ptr)
+{
+    auto cptr = static_cast<internal_type*>(mark::clear(ptr));
+    alloc_traits::destroy(_allocator, cptr);
+    alloc_traits::deallocate(_allocator, cptr, 1);
+}
+
+// aggregates the counters of all handles (including released ones)
+template <class T, class D, class A, size_t hs, size_t ef>
+reclamation_stats era_manager<T, D, A, hs, ef>::get_stats() const
+{
+    reclamation_stats stats;
+    for (int i = _handles.max_id(); i >= 0; --i)
+        mark::clear(_handles.load(i))->_stats.add_to(stats);
+    return stats;
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::print() const
+{
+    otm::out() << "era manager print: era " << _era.load(memo::acquire)
+               << ", " << _handles.max_id() + 1 << "handles" << std::endl;
+    for (int i = 0; i <= _handles.max_id(); ++i)
+    {
+        otm::out() << i << ": " << _handles.load(i) << std::endl;
+    }
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+uint64_t era_manager<T, D, A, hs, ef>::birth_era(const T* ptr)
+{
+    return static_cast<const internal_type*>(ptr)->birth_era;
+}
+
+// does the lifetime of r intersect the interval of any handle
+template <class T, class D, class A, size_t hs, size_t ef>
+bool era_manager<T, D, A, hs, ef>::conflicts(const retired_type& r) const
+{
+    for (int i = _handles.max_id(); i >= 0; --i)
+    {
+        auto temp_handle = _handles.load(i);
+        if (mark::get_mark<0>(temp_handle)) continue;
+        // reading an old lower with a newer upper is conservative
+        auto lower = temp_handle->_lower.load(memo::acquire);
+        auto upper = temp_handle->_upper.load(memo::acquire);
+        if (!lower || !upper) continue;
+        if (r.birth <= upper && lower <= r.retire) return true;
+    }
+    return false;
+}
+
+
+
+
+// *** HANDLE **************************************************************
+// ***** HANDLE CONSTRUCTORS ***********************************************
+template <class T, class D, class A, size_t hs, size_t ef>
+era_manager<T, D, A, hs, ef>::handle_type::handle_type(
+    parent_type& parent, internal_handle& internal, int id)
+    : _parent(parent), _internal(internal), _id(id)
+{
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+era_manager<T, D, A, hs, ef>::handle_type::handle_type(
+    handle_type&& source) noexcept
+    : _parent(source._parent), _internal(source._internal), _id(source._id)
+{
+    source._id = -1;
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+typename era_manager<T, D, A, hs, ef>::handle_type&
+era_manager<T, D, A, hs, ef>::handle_type::operator=(
+    handle_type&& source) noexcept
+{
+    if (&source == this) return *this;
+    this->handle_type::~handle_type();
+    new (this) handle_type(std::move(source));
+    return *this;
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+era_manager<T, D, A, hs, ef>::handle_type::~handle_type()
+{
+    if (_id < 0) return;
+
+    if (_internal._active) end_interval();
+    _internal._active = 0;
+    if (!_internal._retired.empty()) scan();
+
+    _parent._handles.release(_id, &_internal);
+}
+
+
+
+// ***** HANDLE FUNCTIONALITY **********************************************
+template <class T, class D, class A, size_t hs, size_t ef>
+template <class... Args>
+T* era_manager<T, D, A, hs, ef>::handle_type::create_pointer(
+    Args&&... args) const
+{
+    auto temp = alloc_traits::allocate(_parent._allocator, 1);
+    alloc_traits::construct(_parent._allocator, temp,
+                            _parent._era.load(memo::acquire),
+                            std::forward<Args>(args)...);
+    return temp;
+}
+
+// the element was reachable when the era was at most upper, i.e., its birth
+// era is at most upper, and it cannot be retired before lower
+template <class T, class D, class A, size_t hs, size_t ef>
+T* era_manager<T, D, A, hs, ef>::handle_type::protect(
+    const atomic_pointer_type& ptr)
+{
+    if (!_internal._active++) begin_interval();
+
+    auto temp = ptr.load(memo::acquire);
+    while (true)
+    {
+        auto era = _parent._era.load(memo::acquire);
+        if (era == _internal._cached_upper) break;
+        _internal._cached_upper = era;
+        _internal._upper.store(era, memo::relaxed);
+        std::atomic_thread_fence(memo::seq_cst);
+        temp = ptr.load(memo::acquire);
+    }
+
+    if (!mark::clear(temp) && !--_internal._active) end_interval();
+    return temp;
+}
+
+// the element is already protected (or not yet shared)
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::protect_raw(pointer_type)
+{
+    if (!_internal._active++) begin_interval();
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::unprotect(pointer_type)
+{
+    if (!--_internal._active) end_interval();
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::unprotect(
+    std::vector<pointer_type>& vec)
+{
+    for (auto ptr : vec) { unprotect(ptr); }
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+typename era_manager<T, D, A, hs, ef>::handle_type::guard_type
+era_manager<T, D, A, hs, ef>::handle_type::guard(
+    const atomic_pointer_type& aptr)
+{
+    return make_rec_guard(*this, aptr);
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+typename era_manager<T, D, A, hs, ef>::handle_type::guard_type
+era_manager<T, D, A, hs, ef>::handle_type::guard(pointer_type aptr)
+{
+    return make_rec_guard(*this, aptr);
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::safe_delete(pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    _internal._retired.push_back(
+        {cptr, birth_era(cptr), _parent._era.load(memo::acquire)});
+    _internal._stats.retire(_internal._retired.size());
+
+    if (++_internal._retire_counter % ef == 0)
+        _parent._era.fetch_add(1, memo::acq_rel);
+    if (_internal._retired.size() >= _internal._scan_threshold) scan();
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::delete_raw(pointer_type ptr)
+{
+    _parent.delete_raw(ptr);
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+bool era_manager<T, D, A, hs, ef>::handle_type::is_safe(pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    std::atomic_thread_fence(memo::seq_cst);
+    return !_parent.conflicts(
+        {cptr, birth_era(cptr), _parent._era.load(memo::acquire)});
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::print() const
+{
+    out_tm::out() << "* print in era reclamation handle " << _internal._active
+                  << " pointer protected, " << _internal._retired.size()
+                  << " retired *" << std::endl;
+}
+
+// ***** HANDLE HELPER FUNCTION ********************************************
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::begin_interval()
+{
+    auto era                = _parent._era.load(memo::acquire);
+    _internal._cached_upper = era;
+    _internal._upper.store(era, memo::relaxed);
+    _internal._lower.store(era, memo::relaxed);
+    std::atomic_thread_fence(memo::seq_cst);
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::end_interval()
+{
+    _internal._lower.store(0, memo::release);
+    _internal._upper.store(0, memo::release);
+    _internal._cached_upper = 0;
+}
+
+template <class T, class D, class A, size_t hs, size_t ef>
+void era_manager<T, D, A, hs, ef>::handle_type::scan()
+{
+    _internal._stats.scan();
+    // pairs with the fences in begin_interval and protect
+    std::atomic_thread_fence(memo::seq_cst);
+
+    // the destructor might retire further elements, thus, we swap first
+    std::vector<retired_type> retired;
+    retired.swap(_internal._retired);
+    for (auto& r : retired)
+    {
+        if (_parent.conflicts(r))
+            _internal._retired.push_back(r);
+        else
+        {
+            _parent._destructor.destroy(*this, r.ptr);
+            _internal._stats.free();
+        }
+    }
+
+    // the next scan happens once the remaining backlog has doubled
+    _internal._scan_threshold =
+        std::max<size_t>(2 * ef, 2 * _internal._retired.size());
+}
+
+} // namespace reclamation_tm
+} // namespace utils_tm
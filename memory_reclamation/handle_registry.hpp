@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "../concurrency/memory_order.hpp"
+#include "../mark_pointer.hpp"
+
+namespace utils_tm
+{
+namespace reclamation_tm
+{
+
+// Registry of the internal handles of a reclamation manager.  Each handle
+// gets an id, ids are dense and handles of terminated threads are reused.
+// The handles are stored in a lock-free list of segments with SegmentSize
+// slots each (the first segment is part of the registry), new segments are
+// appended when all slots are taken, thus, the number of handles is not
+// bounded.  A released handle is marked (mark bit 0) until it is reused.
+//
+// Segments and handles are only deleted when the registry is destroyed, the
+// manager is responsible for deleting the handles (see load).
+template <class Handle, size_t SegmentSize = 64>
+class handle_registry
+{
+  private:
+    using memo = concurrency_tm::standard_memory_order_policy;
+
+    struct segment
+    {
+        segment() : next(nullptr)
+        {
+            for (auto& h : handles) h.store(nullptr, memo::relaxed);
+        }
+
+        std::atomic<Handle*>  handles[SegmentSize];
+        std::atomic<segment*> next;
+    };
+
+  public:
+    handle_registry() : _max_id(-1) {}
+    handle_registry(const handle_registry&)            = delete;
+    handle_registry& operator=(const handle_registry&) = delete;
+    ~handle_registry();
+
+    // returns a handle (reused or new) and its id
+    inline std::pair<Handle*, int> acquire();
+    inline void                    release(int id, Handle* handle);
+
+    // highest id that was ever acquired (-1 if none)
+    inline int max_id() const { return _max_id.load(memo::acquire); }
+    // nullptr if the id is unused, marked if the handle was released
+    inline Handle* load(int id) const;
+
+  private:
+    std::atomic_int _max_id;
+    segment         _first;
+
+    inline std::atomic<Handle*>& slot(int id) const;
+};
+
+
+
+template <class H, size_t ss>
+handle_registry<H, ss>::~handle_registry()
+{
+    auto seg = _first.next.load(memo::acquire);
+    while (seg)
+    {
+        auto temp = seg->next.load(memo::acquire);
+        delete seg;
+        seg = temp;
+    }
+}
+
+template <class H, size_t ss>
+std::pair<H*, int> handle_registry<H, ss>::acquire()
+{
+    segment* seg = &_first;
+    for (int i = 0;; ++i)
+    {
+        if (i && size_t(i) % ss == 0)
+        {
+            // all slots of seg are taken, move to (or append) the next one
+            auto next = seg->next.load(memo::acquire);
+            if (!next)
+            {
+                auto nseg = new segment();
+                if (seg->next.compare_exchange_strong(next, nseg,
+                                                      memo::acq_rel))
+                    next = nseg;
+                else
+                    delete nseg;
+            }
+            seg = next;
+        }
+
+        auto& s    = seg->handles[size_t(i) % ss];
+        auto  temp = s.load(memo::acquire);
+        if (!temp)
+        {
+            auto nhandle = new H();
+            if (s.compare_exchange_strong(temp, nhandle, memo::acq_rel))
+            {
+                auto b = _max_id.load(memo::acquire);
+                while (b < i)
+                    _max_id.compare_exchange_weak(b, i, memo::acq_rel);
+                return std::make_pair(nhandle, i);
+            }
+            delete nhandle;
+        }
+        if (mark::get_mark<0>(temp))
+        {
+            // reuse old handle
+            if (s.compare_exchange_strong(temp, mark::clear(temp),
+                                          memo::acq_rel))
+                return std::make_pair(mark::clear(temp), i);
+        }
+    }
+}
+
+template <class H, size_t ss>
+void handle_registry<H, ss>::release(int id, H* handle)
+{
+    slot(id).store(mark::mark<0>(handle), memo::release);
+}
+
+template <class H, size_t ss>
+H* handle_registry<H, ss>::load(int id) const
+{
+    return slot(id).load(memo::acquire);
+}
+
+// only for acquired ids, i.e., the segment exists
+template <class H, size_t ss>
+std::atomic<H*>& handle_registry<H, ss>::slot(int id) const
+{
+    auto seg = const_cast<segment*>(&_first);
+    for (size_t k = size_t(id) / ss; k > 0; --k)
+        seg = seg->next.load(memo::acquire);
+    return seg->handles[size_t(id) % ss];
+}
+
+} // namespace reclamation_tm
+} // namespace utils_tm
@@ -1,17 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <tuple>
 #include <vector>
 
+#include "../concurrency/asymmetric_fence.hpp"
 #include "../concurrency/memory_order.hpp"
 #include "../debug.hpp"
 #include "../mark_pointer.hpp"
 #include "../output.hpp"
 
 #include "default_destructor.hpp"
+#include "handle_registry.hpp"
 #include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
 
 namespace utils_tm
 {
@@ -21,40 +25,62 @@ namespace reclamation_tm
 namespace otm = out_tm;
 namespace dtm = debug_tm;
 
+// Handles are registered in a handle_registry, i.e., there is no bound on
+// the number of handles (handlesPerSegment only sets the growth granularity).
+//
+// FencePolicy orders the announcement of a protected pointer before its
+// validation (light) and the scans of safe_delete after the unlinking of the
+// element (heavy).  With concurrency_tm::asymmetric_fence_policy, protect
+// only needs a compiler fence, while scans issue a process wide membarrier.
+// To amortize the membarrier, safe_delete then collects retire_batch pointers
+// per handle and scans them after one heavy fence.  Handing a deletion over
+// to the handle that protects the pointer (continue_deletion) never needs a
+// heavy fence, it happens after the fence of the retiring scan (through the
+// marked protection).
 template <class T,
-          class Destructor      = default_destructor<T>,
-          class Allocator       = std::allocator<T>,
-          size_t maxThreads     = 64,
-          size_t maxProtections = 256>
+          class Destructor         = default_destructor<T>,
+          class Allocator          = std::allocator<T>,
+          size_t handlesPerSegment = 64,
+          size_t maxProtections    = 256,
+          class FencePolicy        = concurrency_tm::symmetric_fence_policy>
 class hazard_manager
 {
   public:
-    using this_type =
-        hazard_manager<T, Destructor, Allocator, maxThreads, maxProtections>;
+    using this_type       = hazard_manager<T,
+                                         Destructor,
+                                         Allocator,
+                                         handlesPerSegment,
+                                         maxProtections,
+                                         FencePolicy>;
     using memo            = concurrency_tm::standard_memory_order_policy;
     using destructor_type = Destructor;
+    using fence_policy    = FencePolicy;
     using allocator_type =
         typename std::allocator_traits<Allocator>::rebind_alloc<T>;
-    using alloc_traits        = std::allocator_traits<Allocator>;
+    using alloc_traits        = std::allocator_traits<allocator_type>;
     using pointer_type        = T*;
     using atomic_pointer_type = std::atomic<T*>;
     using protected_type      = T;
 
+    // number of pointers, that one handle can protect at the same time
+    static constexpr size_t max_protections = maxProtections;
+    // number of retired pointers, that are scanned after one heavy fence
+    static constexpr size_t retire_batch = FencePolicy::is_asymmetric ? 64 : 1;
+
     template <class lT   = T,
-              class lD   = default_destructor<lT>,
+              class lD   = rebind_destructor<Destructor, lT>,
               class lA   = Allocator,
-              size_t lmT = maxThreads,
-              size_t lmP = maxProtections>
+              size_t lmT = handlesPerSegment,
+              size_t lmP = maxProtections,
+              class lF   = FencePolicy>
     struct rebind
     {
-        using other = hazard_manager<lT, lD, lA, lmT, lmP>;
+        using other = hazard_manager<lT, lD, lA, lmT, lmP, lF>;
     };
 
     hazard_manager(destructor_type&& destructor = {}, allocator_type alloc = {})
-        : _destructor(std::move(destructor)), _allocator(alloc),
-          _handle_counter(-1)
+        : _destructor(std::move(destructor)), _allocator(alloc)
     {
-        for (auto& a : _handles) a.store(nullptr, memo::relaxed);
     }
     hazard_manager(const hazard_manager&)             = delete;
     hazard_manager& operator=(const hazard_manager&)  = delete;
@@ -71,14 +97,18 @@ class hazard_manager
             UNMARKED
         };
 
-        internal_handle() : _counter(0)
+        internal_handle() : _counter(0), _nretired(0)
         {
             for (size_t i = 0; i < maxProtections; ++i)
                 _ptr[i].store(nullptr, memo::relaxed);
         }
 
-        std::atomic_int     _counter;
-        atomic_pointer_type _ptr[maxProtections];
+        std::atomic_int                     _counter;
+        atomic_pointer_type                 _ptr[maxProtections];
+        [[no_unique_address]] stats_counter _stats;
+        // retired but not yet scanned (only used by the owner)
+        pointer_type                        _retired[retire_batch];
+        size_t                              _nretired;
 
         inline int                    insert(pointer_type ptr);
         inline std::pair<istate, int> remove(pointer_type ptr);
@@ -96,8 +126,9 @@ class hazard_manager
         using parent_type = hazard_manager<T,
                                            Destructor,
                                            Allocator,
-                                           maxThreads,
-                                           maxProtections>;
+                                           handlesPerSegment,
+                                           maxProtections,
+                                           FencePolicy>;
         using this_type   = handle_type;
         using istate      = typename internal_handle::istate;
 
@@ -134,10 +165,13 @@ class hazard_manager
 
         void print() const;
 
+        // protections currently held by this handle (protect - unprotect)
         size_t n;
 
       private:
         inline void continue_deletion(pointer_type ptr, int pos = -1);
+        inline void scan(pointer_type ptr);
+        inline void scan_retired();
 
         parent_type&     _parent;
         internal_handle& _internal;
@@ -146,79 +180,49 @@ class hazard_manager
     friend handle_type;
     using guard_type = typename handle_type::guard_type;
 
-    handle_type get_handle();
-    void        delete_raw(pointer_type ptr);
-    void        print() const;
+    handle_type       get_handle();
+    void              delete_raw(pointer_type ptr);
+    reclamation_stats get_stats() const;
+    void              print() const;
 
   private:
     [[no_unique_address]] Destructor     _destructor;
     [[no_unique_address]] allocator_type _allocator;
 
-    std::atomic_int               _handle_counter;
-    std::atomic<internal_handle*> _handles[maxThreads];
+    handle_registry<internal_handle, handlesPerSegment> _handles;
 };
 
 
 
-template <class T, class D, class A, size_t mt, size_t mp>
-hazard_manager<T, D, A, mt, mp>::~hazard_manager()
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+hazard_manager<T, D, A, mt, mp, F>::~hazard_manager()
 {
-    auto counter = _handle_counter.load(memo::acquire);
+    auto counter = _handles.max_id();
     for (int i = counter; i >= 0; --i)
     {
-        auto temp = _handles[i].load(memo::acquire);
+        auto temp = _handles.load(i);
         while (!mark::get_mark<0>(temp))
         { /* wait for heandles to be destroyed */
+            temp = _handles.load(i);
         }
     }
 
     for (int i = counter; i >= 0; --i)
     {
-        delete mark::clear(_handles[i].load(memo::acquire));
+        delete mark::clear(_handles.load(i));
     }
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-typename hazard_manager<T, D, A, mt, mp>::handle_type
-hazard_manager<T, D, A, mt, mp>::get_handle()
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+typename hazard_manager<T, D, A, mt, mp, F>::handle_type
+hazard_manager<T, D, A, mt, mp, F>::get_handle()
 {
-    internal_handle* temp0 = new internal_handle();
-    internal_handle* temp1;
-
-    int i = 0;
-    for (; i < int(mt); ++i)
-    {
-        temp1 = _handles[i].load(memo::acquire);
-
-        if (!temp1)
-        {
-            if (_handles[i].compare_exchange_strong(temp1, temp0,
-                                                    memo::acq_rel))
-            {
-                auto b = _handle_counter.load(memo::acquire);
-                while (b < i)
-                    _handle_counter.compare_exchange_weak(b, i, memo::acq_rel);
-                return handle_type(*this, *temp0, i);
-            }
-        }
-        if (mark::get_mark<0>(temp1))
-        {
-            // reuse old handle
-            if (_handles[i].compare_exchange_strong(temp1, mark::clear(temp1),
-                                                    memo::acq_rel))
-            {
-                delete temp0;
-                return handle_type(*this, *mark::clear(temp1), i);
-            }
-        }
-    }
-    otm::out() << "Error: in hazard_manager get_handle -- out of bounds"
-               << std::endl;
-    return handle_type(*this, *temp0, -666);
+    auto [internal, id] = _handles.acquire();
+    return handle_type(*this, *internal, id);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::delete_raw(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::delete_raw(pointer_type ptr)
 {
     // delete mark::clear(ptr);
     auto cptr = mark::clear(ptr);
@@ -226,16 +230,26 @@ void hazard_manager<T, D, A, mt, mp>::delete_raw(pointer_type ptr)
     alloc_traits::deallocate(_allocator, cptr, 1);
 }
 
+// aggregates the counters of all handles (including released ones)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+reclamation_stats hazard_manager<T, D, A, mt, mp, F>::get_stats() const
+{
+    reclamation_stats stats;
+    for (int i = _handles.max_id(); i >= 0; --i)
+        mark::clear(_handles.load(i))->_stats.add_to(stats);
+    return stats;
+}
+
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::print() const
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::print() const
 {
     otm::out() << "hazard manager print: "
-               << _handle_counter.load(memo::acquire) + 1 << "handles"
+               << _handles.max_id() + 1 << "handles"
                << std::endl;
-    for (size_t i = 0; i < mt; ++i)
+    for (int i = 0; i <= _handles.max_id(); ++i)
     {
-        otm::out() << i << ": " << _handles[i].load(memo::acquire) << std::endl;
+        otm::out() << i << ": " << _handles.load(i) << std::endl;
     }
 }
 
@@ -243,10 +257,14 @@ void hazard_manager<T, D, A, mt, mp>::print() const
 
 
 // *** INTERNAL HANDLE *****************************************************
-template <class T, class D, class A, size_t mt, size_t mp>
-int hazard_manager<T, D, A, mt, mp>::internal_handle::insert(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+int hazard_manager<T, D, A, mt, mp, F>::internal_handle::insert(
+    pointer_type ptr)
 {
-    auto pos = _counter.fetch_add(1, memo::acquire);
+    // only the owner changes the counter, thus, no read-modify-write is
+    // needed (the fence policy orders the insertion before the validation)
+    auto pos = _counter.load(memo::relaxed);
+    _counter.store(pos + 1, memo::release);
     dtm::if_debug_critical("Error: in insert -- "
                            "too many protected pointers",
                            pos >= int(mp));
@@ -258,10 +276,10 @@ int hazard_manager<T, D, A, mt, mp>::internal_handle::insert(pointer_type ptr)
     return pos;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-std::pair<typename hazard_manager<T, D, A, mt, mp>::internal_handle::istate,
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+std::pair<typename hazard_manager<T, D, A, mt, mp, F>::internal_handle::istate,
           int>
-hazard_manager<T, D, A, mt, mp>::internal_handle::remove(pointer_type ptr)
+hazard_manager<T, D, A, mt, mp, F>::internal_handle::remove(pointer_type ptr)
 {
     auto pos = find(ptr);
     if (pos < 0) { return std::make_pair(istate::NOT_FOUND, -1); }
@@ -311,9 +329,9 @@ hazard_manager<T, D, A, mt, mp>::internal_handle::remove(pointer_type ptr)
     return std::make_pair(was_marked ? istate::MARKED : istate::UNMARKED, pos);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-typename hazard_manager<T, D, A, mt, mp>::internal_handle::istate
-hazard_manager<T, D, A, mt, mp>::internal_handle::replace(int          i,
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+typename hazard_manager<T, D, A, mt, mp, F>::internal_handle::istate
+hazard_manager<T, D, A, mt, mp, F>::internal_handle::replace(int          i,
                                                           pointer_type ptr)
 {
     auto temp = _ptr[i].exchange(ptr, memo::acq_rel);
@@ -321,9 +339,9 @@ hazard_manager<T, D, A, mt, mp>::internal_handle::replace(int          i,
 }
 
 // has to work concurrently
-template <class T, class D, class A, size_t mt, size_t mp>
-typename hazard_manager<T, D, A, mt, mp>::internal_handle::istate
-hazard_manager<T, D, A, mt, mp>::internal_handle::mark(pointer_type ptr,
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+typename hazard_manager<T, D, A, mt, mp, F>::internal_handle::istate
+hazard_manager<T, D, A, mt, mp, F>::internal_handle::mark(pointer_type ptr,
                                                        int          pos)
 {
     auto temp = pos;
@@ -353,8 +371,8 @@ hazard_manager<T, D, A, mt, mp>::internal_handle::mark(pointer_type ptr,
     return istate::NOT_FOUND;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-int hazard_manager<T, D, A, mt, mp>::internal_handle::find(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+int hazard_manager<T, D, A, mt, mp, F>::internal_handle::find(
     pointer_type ptr) const
 {
     auto temp = _counter.load(memo::acquire);
@@ -373,8 +391,8 @@ int hazard_manager<T, D, A, mt, mp>::internal_handle::find(
     return -1;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::internal_handle::print() const
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::internal_handle::print() const
 {
 
     auto temp = _counter.load(memo::acquire);
@@ -385,24 +403,24 @@ void hazard_manager<T, D, A, mt, mp>::internal_handle::print() const
 
 // *** HANDLE **************************************************************
 // ***** HANDLE CONSTRUCTORS ***********************************************
-template <class T, class D, class A, size_t mt, size_t mp>
-hazard_manager<T, D, A, mt, mp>::handle_type::handle_type(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+hazard_manager<T, D, A, mt, mp, F>::handle_type::handle_type(
     parent_type& parent, internal_handle& internal, int id)
     : n(0), _parent(parent), _internal(internal), _id(id)
 {
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-hazard_manager<T, D, A, mt, mp>::handle_type::handle_type(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+hazard_manager<T, D, A, mt, mp, F>::handle_type::handle_type(
     handle_type&& source) noexcept
     : _parent(source._parent), _internal(source._internal), _id(source._id)
 {
     source._id = -1;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-typename hazard_manager<T, D, A, mt, mp>::handle_type&
-hazard_manager<T, D, A, mt, mp>::handle_type::operator=(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+typename hazard_manager<T, D, A, mt, mp, F>::handle_type&
+hazard_manager<T, D, A, mt, mp, F>::handle_type::operator=(
     handle_type&& source) noexcept
 {
     if (&source == this) return *this;
@@ -411,11 +429,12 @@ hazard_manager<T, D, A, mt, mp>::handle_type::operator=(
     return *this;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-hazard_manager<T, D, A, mt, mp>::handle_type::~handle_type()
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+hazard_manager<T, D, A, mt, mp, F>::handle_type::~handle_type()
 {
     if (_id < 0) return;
 
+    scan_retired();
     for (int i = _internal._counter.load(memo::acquire) - 1; i >= 0; --i)
     {
         auto temp = _internal._ptr[i].exchange(nullptr, memo::acquire);
@@ -423,15 +442,15 @@ hazard_manager<T, D, A, mt, mp>::handle_type::~handle_type()
     }
     _internal._counter.store(0, memo::release);
 
-    _parent._handles[_id].store(mark::mark<0>(&_internal), memo::release);
+    _parent._handles.release(_id, &_internal);
 }
 
 
 
 // ***** HANDLE FUNCTIONALITY **********************************************
-template <class T, class D, class A, size_t mt, size_t mp>
+template <class T, class D, class A, size_t mt, size_t mp, class F>
 template <class... Args>
-T* hazard_manager<T, D, A, mt, mp>::handle_type::create_pointer(
+T* hazard_manager<T, D, A, mt, mp, F>::handle_type::create_pointer(
     Args&&... args) const
 {
     // auto temp = new T(std::forward<Args>(args)...);
@@ -441,8 +460,8 @@ T* hazard_manager<T, D, A, mt, mp>::handle_type::create_pointer(
     return temp;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-T* hazard_manager<T, D, A, mt, mp>::handle_type::protect(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+T* hazard_manager<T, D, A, mt, mp, F>::handle_type::protect(
     const atomic_pointer_type& ptr)
 {
     ++n;
@@ -450,10 +469,12 @@ T* hazard_manager<T, D, A, mt, mp>::handle_type::protect(
     if (!mark::clear(temp0)) return temp0;
     temp0      = mark::clear(temp0);
     auto pos   = _internal.insert(temp0);
+    F::light();
     auto temp1 = ptr.load(memo::acquire);
     while (temp0 != mark::clear(temp1))
     {
         auto state = _internal.replace(pos, mark::clear(temp1));
+        F::light();
         if (state == istate::MARKED) continue_deletion(temp0, pos);
         temp1 = mark::clear(temp1);
         if (!temp1)
@@ -469,15 +490,18 @@ T* hazard_manager<T, D, A, mt, mp>::handle_type::protect(
     return temp1;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::protect_raw(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::protect_raw(
+    pointer_type ptr)
 {
     ++n;
     _internal.insert(mark::clear(ptr));
+    F::light();
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::unprotect(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::unprotect(
+    pointer_type ptr)
 {
     --n;
     auto cptr      = mark::clear(ptr);
@@ -487,44 +511,50 @@ void hazard_manager<T, D, A, mt, mp>::handle_type::unprotect(pointer_type ptr)
     if (st == istate::MARKED) continue_deletion(cptr, pos);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::unprotect(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::unprotect(
     std::vector<pointer_type>& vec)
 {
     for (auto ptr : vec) { unprotect(ptr); }
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-typename hazard_manager<T, D, A, mt, mp>::handle_type::guard_type
-hazard_manager<T, D, A, mt, mp>::handle_type::guard(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+typename hazard_manager<T, D, A, mt, mp, F>::handle_type::guard_type
+hazard_manager<T, D, A, mt, mp, F>::handle_type::guard(
     const atomic_pointer_type& aptr)
 {
     return make_rec_guard(*this, aptr);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-typename hazard_manager<T, D, A, mt, mp>::handle_type::guard_type
-hazard_manager<T, D, A, mt, mp>::handle_type::guard(pointer_type aptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+typename hazard_manager<T, D, A, mt, mp, F>::handle_type::guard_type
+hazard_manager<T, D, A, mt, mp, F>::handle_type::guard(pointer_type aptr)
 {
     return make_rec_guard(*this, aptr);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::safe_delete(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::safe_delete(
+    pointer_type ptr)
 {
     auto cptr = mark::clear(ptr);
-    for (int i = _parent._handle_counter.load(memo::acquire); i >= 0; --i)
+    _internal._stats.retire();
+    if constexpr (retire_batch == 1)
     {
-        auto temp_handle = _parent._handles[i].load(memo::acquire);
-        if (mark::get_mark<0>(temp_handle)) continue;
-        if (temp_handle->mark(cptr) != istate::NOT_FOUND) return;
+        _internal._stats.scan();
+        F::heavy();
+        scan(cptr);
+    }
+    else
+    {
+        _internal._retired[_internal._nretired++] = cptr;
+        if (_internal._nretired == retire_batch) scan_retired();
     }
-
-    _parent._destructor.destroy(*this, ptr);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::delete_raw(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::delete_raw(
+    pointer_type ptr)
 {
     // delete mark::clear(ptr);
     auto cptr = mark::clear(ptr);
@@ -532,26 +562,27 @@ void hazard_manager<T, D, A, mt, mp>::handle_type::delete_raw(pointer_type ptr)
     alloc_traits::deallocate(_parent._allocator, cptr, 1);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-bool hazard_manager<T, D, A, mt, mp>::handle_type::is_safe(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+bool hazard_manager<T, D, A, mt, mp, F>::handle_type::is_safe(pointer_type ptr)
 {
     auto cptr = mark::clear(ptr);
-    for (int i = _parent._handle_counter.load(memo::acquire); i >= 0; --i)
+    F::heavy();
+    for (int i = _parent._handles.max_id(); i >= 0; --i)
     {
-        auto temp_handle = _parent._handles[i].load(memo::acquire);
+        auto temp_handle = _parent._handles.load(i);
         if (mark::get_mark<0>(temp_handle)) continue;
         if (temp_handle->find(cptr) != -1) return false;
     }
     return true;
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::print(pointer_type ptr)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::print(pointer_type ptr)
 {
     auto cptr = mark::clear(ptr);
-    for (int i = _parent._handle_counter.load(memo::acquire); i >= 0; --i)
+    for (int i = _parent._handles.max_id(); i >= 0; --i)
     {
-        auto temp_handle = _parent._handles[i].load(memo::acquire);
+        auto temp_handle = _parent._handles.load(i);
         if (mark::get_mark<0>(temp_handle)) continue;
         if (temp_handle->find(cptr) != -1)
             otm::out() << "element is protected in handle " << i << std::endl;
@@ -559,25 +590,63 @@ void hazard_manager<T, D, A, mt, mp>::handle_type::print(pointer_type ptr)
 }
 
 // ***** HANDLE HELPER FUNCTION ********************************************
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::continue_deletion(
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::continue_deletion(
     pointer_type ptr, int pos)
 {
     auto temp = _internal.mark(ptr, pos);
     if (temp != istate::NOT_FOUND) return;
 
+    // the heavy fence of the retiring scan happened before the mark, thus,
+    // all protections it could miss are visible
+    _internal._stats.scan();
+    std::atomic_thread_fence(memo::seq_cst);
     for (int i = _id - 1; i >= 0; --i)
     {
-        auto temp_handle = _parent._handles[i].load(memo::acquire);
+        auto temp_handle = _parent._handles.load(i);
+        if (mark::get_mark<0>(temp_handle)) continue;
+        if (temp_handle->mark(ptr) != istate::NOT_FOUND) return;
+    }
+
+    _parent._destructor.destroy(*this, ptr);
+    _internal._stats.free();
+}
+
+// marks ptr in the first handle that protects it (that handle continues the
+// deletion), or deletes it (the caller has issued the heavy fence)
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::scan(pointer_type ptr)
+{
+    for (int i = _parent._handles.max_id(); i >= 0; --i)
+    {
+        auto temp_handle = _parent._handles.load(i);
         if (mark::get_mark<0>(temp_handle)) continue;
         if (temp_handle->mark(ptr) != istate::NOT_FOUND) return;
     }
 
     _parent._destructor.destroy(*this, ptr);
+    _internal._stats.free();
+}
+
+// one heavy fence for all retired pointers of this handle
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::scan_retired()
+{
+    auto nretired = _internal._nretired;
+    if (!nretired) return;
+
+    // copied, since destructors could retire more pointers
+    pointer_type retired[retire_batch];
+    std::copy(_internal._retired, _internal._retired + nretired, retired);
+    _internal._nretired = 0;
+
+    _internal._stats.scan();
+    F::heavy();
+    for (size_t i = 0; i < nretired; ++i) scan(retired[i]);
 }
 
-template <class T, class D, class A, size_t mt, size_t mp>
-void hazard_manager<T, D, A, mt, mp>::handle_type::print() const
+template <class T, class D, class A, size_t mt, size_t mp, class F>
+void hazard_manager<T, D, A, mt, mp, F>::handle_type::print() const
 {
     out_tm::out() << "* print in hazard reclamation handle "
                   << _internal._counter.load(memo::acquire)
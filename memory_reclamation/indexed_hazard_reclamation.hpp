@@ -0,0 +1,498 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../concurrency/memory_order.hpp"
+#include "../debug.hpp"
+#include "../mark_pointer.hpp"
+#include "../output.hpp"
+
+#include "default_destructor.hpp"
+#include "handle_registry.hpp"
+#include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
+
+namespace utils_tm
+{
+namespace reclamation_tm
+{
+
+namespace otm = out_tm;
+namespace dtm = debug_tm;
+
+// Hazard pointers with a fixed number of indexed slots per handle.  Unlike
+// hazard_manager, protecting a pointer takes the lowest free slot (found with
+// one bit operation on an owner local bitmask), and releasing a slot is a
+// single store of nullptr, no other handle ever writes into our slots.
+// Therefore, safe_delete cannot hand over the responsibility of deleting an
+// element to a protecting handle, instead, elements are retired into a
+// handle local list, which is scanned once it grows larger than the number
+// of slots that could protect its elements.
+//
+// acquire_slot/protect(ptr, slot)/release_slot make the slot index explicit,
+// the generic interface (protect/unprotect(ptr) and guards) has to find the
+// slot of a pointer, but only occupied slots are visited.
+template <class T,
+          class Destructor         = default_destructor<T>,
+          class Allocator          = std::allocator<T>,
+          size_t handlesPerSegment = 64,
+          size_t slotsPerHandle    = 64>
+class indexed_hazard_manager
+{
+  private:
+    static_assert(slotsPerHandle > 0 && slotsPerHandle <= 64,
+                  "the free slots of a handle are stored in a bitmask");
+
+  public:
+    using this_type = indexed_hazard_manager<T,
+                                             Destructor,
+                                             Allocator,
+                                             handlesPerSegment,
+                                             slotsPerHandle>;
+    using memo            = concurrency_tm::standard_memory_order_policy;
+    using destructor_type = Destructor;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::rebind_alloc<T>;
+    using alloc_traits        = std::allocator_traits<allocator_type>;
+    using pointer_type        = T*;
+    using atomic_pointer_type = std::atomic<T*>;
+    using protected_type      = T;
+
+    // number of pointers, that one handle can protect at the same time
+    static constexpr size_t max_protections = slotsPerHandle;
+
+    template <class lT   = T,
+              class lD   = rebind_destructor<Destructor, lT>,
+              class lA   = Allocator,
+              size_t lmT = handlesPerSegment,
+              size_t lsH = slotsPerHandle>
+    struct rebind
+    {
+        using other = indexed_hazard_manager<lT, lD, lA, lmT, lsH>;
+    };
+
+    indexed_hazard_manager(destructor_type&& destructor = {},
+                           allocator_type    alloc      = {})
+        : _destructor(std::move(destructor)), _allocator(alloc)
+    {
+    }
+    indexed_hazard_manager(const indexed_hazard_manager&)            = delete;
+    indexed_hazard_manager& operator=(const indexed_hazard_manager&) = delete;
+    indexed_hazard_manager(indexed_hazard_manager&& other)           = delete;
+    indexed_hazard_manager& operator=(indexed_hazard_manager&& other) = delete;
+    ~indexed_hazard_manager();
+
+    // the slots are read by all handles, everything else is only used by
+    // the current owner (retired elements survive the owning handle)
+    struct alignas(64) internal_handle
+    {
+        internal_handle() : _free(all_free)
+        {
+            for (auto& s : _slots) s.store(nullptr, memo::relaxed);
+        }
+
+        static constexpr uint64_t all_free =
+            (slotsPerHandle == 64) ? ~uint64_t(0)
+                                   : (uint64_t(1) << slotsPerHandle) - 1;
+
+        atomic_pointer_type                 _slots[slotsPerHandle];
+        uint64_t                            _free;
+        std::vector<pointer_type>           _retired;
+        [[no_unique_address]] stats_counter _stats;
+    };
+
+    class handle_type
+    {
+      private:
+        using parent_type = indexed_hazard_manager<T,
+                                                   Destructor,
+                                                   Allocator,
+                                                   handlesPerSegment,
+                                                   slotsPerHandle>;
+        using this_type   = handle_type;
+
+      public:
+        using pointer_type        = typename parent_type::pointer_type;
+        using atomic_pointer_type = typename parent_type::atomic_pointer_type;
+        using guard_type          = reclamation_guard<T, this_type>;
+
+        handle_type(parent_type& parent, internal_handle& internal, int id);
+        handle_type(const handle_type&)            = delete;
+        handle_type& operator=(const handle_type&) = delete;
+        // handles should not be moved while other operations are ongoing
+        handle_type(handle_type&& other) noexcept;
+        handle_type& operator=(handle_type&& other) noexcept;
+        ~handle_type();
+
+        template <class... Args>
+        inline T* create_pointer(Args&&... args) const;
+
+        inline T*   protect(const atomic_pointer_type& ptr);
+        inline void protect_raw(pointer_type ptr);
+
+        inline void unprotect(pointer_type ptr);
+        inline void unprotect(std::vector<T*>& vec);
+
+        // indexed interface, the slot stays acquired until it is released
+        // (it can be reused by multiple protects)
+        inline size_t acquire_slot();
+        inline T*     protect(const atomic_pointer_type& ptr, size_t slot);
+        inline void   protect_raw(pointer_type ptr, size_t slot);
+        inline void   release_slot(size_t slot);
+
+        inline guard_type guard(const atomic_pointer_type& ptr);
+        inline guard_type guard(pointer_type ptr);
+
+        inline void safe_delete(pointer_type ptr);
+        inline void delete_raw(pointer_type ptr);
+        inline bool is_safe(pointer_type ptr);
+
+        void print() const;
+
+      private:
+        inline void scan();
+
+        parent_type&     _parent;
+        internal_handle& _internal;
+        int              _id;
+    };
+    friend handle_type;
+    using guard_type = typename handle_type::guard_type;
+
+    handle_type       get_handle();
+    void              delete_raw(pointer_type ptr);
+    reclamation_stats get_stats() const;
+    void              print() const;
+
+  private:
+    [[no_unique_address]] Destructor     _destructor;
+    [[no_unique_address]] allocator_type _allocator;
+
+    handle_registry<internal_handle, handlesPerSegment> _handles;
+
+    inline void collect_protected(std::vector<pointer_type>& out) const;
+};
+
+
+
+template <class T, class D, class A, size_t mt, size_t sh>
+indexed_hazard_manager<T, D, A, mt, sh>::~indexed_hazard_manager()
+{
+    auto counter = _handles.max_id();
+    for (int i = counter; i >= 0; --i)
+    {
+        auto temp = _handles.load(i);
+        while (!mark::get_mark<0>(temp))
+        { /* wait for handles to be destroyed */
+            temp = _handles.load(i);
+        }
+    }
+
+    // no handle is left, i.e., all retired elements are unprotected
+    for (int i = counter; i >= 0; --i)
+    {
+        auto internal = mark::clear(_handles.load(i));
+        for (auto ptr : internal->_retired) _destructor.destroy(*this, ptr);
+        delete internal;
+    }
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+typename indexed_hazard_manager<T, D, A, mt, sh>::handle_type
+indexed_hazard_manager<T, D, A, mt, sh>::get_handle()
+{
+    auto [internal, id] = _handles.acquire();
+    return handle_type(*this, *internal, id);
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::delete_raw(pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    alloc_traits::destroy(_allocator, cptr);
+    alloc_traits::deallocate(_allocator, cptr, 1);
+}
+
+// aggregates the counters of all handles (including released ones)
+template <class T, class D, class A, size_t mt, size_t sh>
+reclamation_stats indexed_hazard_manager<T, D, A, mt, sh>::get_stats() const
+{
+    reclamation_stats stats;
+    for (int i = _handles.max_id(); i >= 0; --i)
+        mark::clear(_handles.load(i))->_stats.add_to(stats);
+    return stats;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::print() const
+{
+    otm::out() << "indexed hazard manager print: "
+               << _handles.max_id() + 1 << "handles"
+               << std::endl;
+    for (int i = 0; i <= _handles.max_id(); ++i)
+    {
+        otm::out() << i << ": " << _handles.load(i) << std::endl;
+    }
+}
+
+// collects (sorted) all pointers that are currently protected by any handle
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::collect_protected(
+    std::vector<pointer_type>& out) const
+{
+    // pairs with the fence in protect, either we see the hazard, or the
+    // protecting thread sees that the element was unlinked
+    std::atomic_thread_fence(memo::seq_cst);
+    for (int i = _handles.max_id(); i >= 0; --i)
+    {
+        auto temp_handle = _handles.load(i);
+        if (mark::get_mark<0>(temp_handle)) continue;
+        for (auto& s : temp_handle->_slots)
+        {
+            auto temp = s.load(memo::acquire);
+            if (temp) out.push_back(temp);
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+
+
+
+// *** HANDLE **************************************************************
+// ***** HANDLE CONSTRUCTORS ***********************************************
+template <class T, class D, class A, size_t mt, size_t sh>
+indexed_hazard_manager<T, D, A, mt, sh>::handle_type::handle_type(
+    parent_type& parent, internal_handle& internal, int id)
+    : _parent(parent), _internal(internal), _id(id)
+{
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+indexed_hazard_manager<T, D, A, mt, sh>::handle_type::handle_type(
+    handle_type&& source) noexcept
+    : _parent(source._parent), _internal(source._internal), _id(source._id)
+{
+    source._id = -1;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+typename indexed_hazard_manager<T, D, A, mt, sh>::handle_type&
+indexed_hazard_manager<T, D, A, mt, sh>::handle_type::operator=(
+    handle_type&& source) noexcept
+{
+    if (&source == this) return *this;
+    this->handle_type::~handle_type();
+    new (this) handle_type(std::move(source));
+    return *this;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+indexed_hazard_manager<T, D, A, mt, sh>::handle_type::~handle_type()
+{
+    if (_id < 0) return;
+
+    for (auto& s : _internal._slots) s.store(nullptr, memo::release);
+    _internal._free = internal_handle::all_free;
+    if (!_internal._retired.empty()) scan();
+
+    _parent._handles.release(_id, &_internal);
+}
+
+
+
+// ***** HANDLE FUNCTIONALITY **********************************************
+template <class T, class D, class A, size_t mt, size_t sh>
+template <class... Args>
+T* indexed_hazard_manager<T, D, A, mt, sh>::handle_type::create_pointer(
+    Args&&... args) const
+{
+    auto temp = alloc_traits::allocate(_parent._allocator, 1);
+    alloc_traits::construct(_parent._allocator, temp,
+                            std::forward<Args>(args)...);
+    return temp;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+T* indexed_hazard_manager<T, D, A, mt, sh>::handle_type::protect(
+    const atomic_pointer_type& ptr)
+{
+    auto temp = ptr.load(memo::acquire);
+    if (!mark::clear(temp)) return temp;
+
+    auto slot = acquire_slot();
+    temp      = protect(ptr, slot);
+    if (!mark::clear(temp)) release_slot(slot);
+    return temp;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::protect_raw(
+    pointer_type ptr)
+{
+    protect_raw(ptr, acquire_slot());
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::unprotect(
+    pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    auto used = ~_internal._free & internal_handle::all_free;
+    while (used)
+    {
+        size_t i = std::countr_zero(used);
+        if (_internal._slots[i].load(memo::relaxed) == cptr)
+        {
+            release_slot(i);
+            return;
+        }
+        used &= used - 1;
+    }
+    dtm::if_debug("Warning: in recl handle unprotect -- pointer not found");
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::unprotect(
+    std::vector<pointer_type>& vec)
+{
+    for (auto ptr : vec) { unprotect(ptr); }
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+size_t indexed_hazard_manager<T, D, A, mt, sh>::handle_type::acquire_slot()
+{
+    dtm::if_debug_critical("Error: in acquire_slot -- "
+                           "too many protected pointers",
+                           !_internal._free);
+    size_t slot = std::countr_zero(_internal._free);
+    _internal._free &= _internal._free - 1;
+    return slot;
+}
+
+// the slot is published before the pointer is validated (the fence orders
+// the store before the reload), equality is checked modulo mark bits
+template <class T, class D, class A, size_t mt, size_t sh>
+T* indexed_hazard_manager<T, D, A, mt, sh>::handle_type::protect(
+    const atomic_pointer_type& ptr, size_t slot)
+{
+    auto temp0 = ptr.load(memo::acquire);
+    while (true)
+    {
+        _internal._slots[slot].store(mark::clear(temp0), memo::relaxed);
+        std::atomic_thread_fence(memo::seq_cst);
+        auto temp1 = ptr.load(memo::acquire);
+        if (mark::clear(temp0) == mark::clear(temp1)) return temp1;
+        temp0 = temp1;
+    }
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::protect_raw(
+    pointer_type ptr, size_t slot)
+{
+    _internal._slots[slot].store(mark::clear(ptr), memo::relaxed);
+    std::atomic_thread_fence(memo::seq_cst);
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::release_slot(
+    size_t slot)
+{
+    _internal._slots[slot].store(nullptr, memo::release);
+    _internal._free |= uint64_t(1) << slot;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+typename indexed_hazard_manager<T, D, A, mt, sh>::handle_type::guard_type
+indexed_hazard_manager<T, D, A, mt, sh>::handle_type::guard(
+    const atomic_pointer_type& aptr)
+{
+    return make_rec_guard(*this, aptr);
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+typename indexed_hazard_manager<T, D, A, mt, sh>::handle_type::guard_type
+indexed_hazard_manager<T, D, A, mt, sh>::handle_type::guard(pointer_type aptr)
+{
+    return make_rec_guard(*this, aptr);
+}
+
+// scans, once there are more retired elements than slots (amortized O(1))
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::safe_delete(
+    pointer_type ptr)
+{
+    _internal._retired.push_back(mark::clear(ptr));
+    _internal._stats.retire(_internal._retired.size());
+
+    size_t threshold =
+        2 * sh * size_t(_parent._handles.max_id() + 1);
+    if (_internal._retired.size() >= threshold) scan();
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::delete_raw(
+    pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    alloc_traits::destroy(_parent._allocator, cptr);
+    alloc_traits::deallocate(_parent._allocator, cptr, 1);
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+bool indexed_hazard_manager<T, D, A, mt, sh>::handle_type::is_safe(
+    pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    std::atomic_thread_fence(memo::seq_cst);
+    for (int i = _parent._handles.max_id(); i >= 0; --i)
+    {
+        auto temp_handle = _parent._handles.load(i);
+        if (mark::get_mark<0>(temp_handle)) continue;
+        for (auto& s : temp_handle->_slots)
+            if (s.load(memo::acquire) == cptr) return false;
+    }
+    return true;
+}
+
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::print() const
+{
+    out_tm::out() << "* print in indexed hazard reclamation handle "
+                  << std::popcount(~_internal._free &
+                                   internal_handle::all_free)
+                  << " slots used, " << _internal._retired.size()
+                  << " retired *" << std::endl;
+}
+
+// ***** HANDLE HELPER FUNCTION ********************************************
+template <class T, class D, class A, size_t mt, size_t sh>
+void indexed_hazard_manager<T, D, A, mt, sh>::handle_type::scan()
+{
+    _internal._stats.scan();
+    std::vector<pointer_type> hazards;
+    _parent.collect_protected(hazards);
+
+    // the destructor might retire further elements, thus, we swap first
+    std::vector<pointer_type> retired;
+    retired.swap(_internal._retired);
+    for (auto ptr : retired)
+    {
+        if (std::binary_search(hazards.begin(), hazards.end(), ptr))
+            _internal._retired.push_back(ptr);
+        else
+        {
+            _parent._destructor.destroy(*this, ptr);
+            _internal._stats.free();
+        }
+    }
+}
+
+} // namespace reclamation_tm
+} // namespace utils_tm
@@ -0,0 +1,391 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../concurrency/memory_order.hpp"
+#include "../data_structures/circular_buffer.hpp"
+#include "../mark_pointer.hpp"
+#include "../output.hpp"
+
+#include "default_destructor.hpp"
+#include "handle_registry.hpp"
+#include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
+
+namespace utils_tm
+{
+namespace reclamation_tm
+{
+
+namespace otm = out_tm;
+
+// Quiescent-state-based reclamation.  Like delayed_manager, protect is a
+// plain load, and unprotect does nothing.  Additionally, each handle has to
+// announce quiescent points (calls to quiescent), i.e., points where it does
+// not hold any references into the data structure (e.g. between operations).
+//
+// There is a global epoch, each quiescent call announces the current epoch.
+// Once all active handles announced the current epoch, it is advanced.  An
+// element retired in epoch e is deleted once the epoch reaches e + 2, by
+// then, every handle passed a quiescent point after the element was unlinked.
+// Thus, memory stays bounded as long as all handles announce quiescent
+// points regularly (destroyed handles are ignored).
+template <class T,
+          class Destructor         = default_destructor<T>,
+          class Allocator          = std::allocator<T>,
+          size_t handlesPerSegment = 64>
+class quiescent_manager
+{
+  public:
+    using this_type =
+        quiescent_manager<T, Destructor, Allocator, handlesPerSegment>;
+    using memo            = concurrency_tm::standard_memory_order_policy;
+    using destructor_type = Destructor;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::rebind_alloc<T>;
+    using alloc_traits        = std::allocator_traits<allocator_type>;
+    using pointer_type        = T*;
+    using atomic_pointer_type = std::atomic<T*>;
+    using protected_type      = T;
+
+    template <class lT   = T,
+              class lD   = rebind_destructor<Destructor, lT>,
+              class lA   = Allocator,
+              size_t lhS = handlesPerSegment>
+    struct rebind
+    {
+        using other = quiescent_manager<lT, lD, lA, lhS>;
+    };
+
+    quiescent_manager(destructor_type&& destructor = {},
+                      allocator_type    alloc      = {})
+        : _destructor(std::move(destructor)), _allocator(alloc), _epoch(1)
+    {
+    }
+    quiescent_manager(const quiescent_manager&)             = delete;
+    quiescent_manager& operator=(const quiescent_manager&)  = delete;
+    quiescent_manager(quiescent_manager&& other)            = delete;
+    quiescent_manager& operator=(quiescent_manager&& other) = delete;
+    ~quiescent_manager();
+
+    struct retired_type
+    {
+        pointer_type ptr;
+        uint64_t     epoch;
+    };
+
+    // the announced epoch is read by all handles, the retired elements are
+    // only used by the current owner (they are sorted by epoch)
+    struct alignas(64) internal_handle
+    {
+        internal_handle() : _announced(0) {}
+
+        std::atomic_uint64_t                _announced;
+        circular_buffer<retired_type>       _retired;
+        [[no_unique_address]] stats_counter _stats;
+    };
+
+    class handle_type
+    {
+      private:
+        using parent_type =
+            quiescent_manager<T, Destructor, Allocator, handlesPerSegment>;
+        using this_type = handle_type;
+
+      public:
+        using pointer_type        = typename parent_type::pointer_type;
+        using atomic_pointer_type = typename parent_type::atomic_pointer_type;
+        using guard_type          = reclamation_guard<T, this_type>;
+
+        handle_type(parent_type& parent, internal_handle& internal, int id);
+        handle_type(const handle_type&)            = delete;
+        handle_type& operator=(const handle_type&) = delete;
+        handle_type(handle_type&& other) noexcept;
+        handle_type& operator=(handle_type&& other) noexcept;
+        ~handle_type();
+
+        template <class... Args>
+        inline T* create_pointer(Args&&... args) const;
+
+        inline T*   protect(const atomic_pointer_type& ptr) const;
+        inline void protect_raw(pointer_type ptr) const;
+
+        inline void unprotect(pointer_type ptr) const;
+        inline void unprotect(std::vector<T*>& vec) const;
+
+        inline guard_type guard(const atomic_pointer_type& ptr);
+        inline guard_type guard(pointer_type ptr);
+
+        inline void safe_delete(pointer_type ptr);
+        inline void delete_raw(pointer_type ptr);
+        inline bool is_safe(pointer_type ptr);
+
+        // the handle holds no references into the data structure
+        inline void quiescent();
+
+        void print() const;
+
+      private:
+        inline void drain(uint64_t epoch);
+
+        parent_type&     _parent;
+        internal_handle& _internal;
+        int              _id;
+    };
+    friend handle_type;
+    using guard_type = typename handle_type::guard_type;
+
+    handle_type       get_handle();
+    void              delete_raw(pointer_type ptr);
+    reclamation_stats get_stats() const;
+    void              print() const;
+
+  private:
+    [[no_unique_address]] Destructor     _destructor;
+    [[no_unique_address]] allocator_type _allocator;
+
+    alignas(64) std::atomic_uint64_t _epoch;
+    handle_registry<internal_handle, handlesPerSegment> _handles;
+
+    inline uint64_t try_advance(uint64_t epoch);
+};
+
+
+
+template <class T, class D, class A, size_t hs>
+quiescent_manager<T, D, A, hs>::~quiescent_manager()
+{
+    auto counter = _handles.max_id();
+    for (int i = counter; i >= 0; --i)
+    {
+        auto temp = _handles.load(i);
+        while (!mark::get_mark<0>(temp))
+        { /* wait for handles to be destroyed */
+            temp = _handles.load(i);
+        }
+    }
+
+    // no handle is left, i.e., all retired elements are unreachable
+    for (int i = counter; i >= 0; --i)
+    {
+        auto internal = mark::clear(_handles.load(i));
+        for (auto& r : internal->_retired) _destructor.destroy(*this, r.ptr);
+        delete internal;
+    }
+}
+
+template <class T, class D, class A, size_t hs>
+typename quiescent_manager<T, D, A, hs>::handle_type
+quiescent_manager<T, D, A, hs>::get_handle()
+{
+    auto [internal, id] = _handles.acquire();
+    return handle_type(*this, *internal, id);
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::delete_raw(pointer_type ptr)
+{
+    auto cptr = mark::clear(ptr);
+    alloc_traits::destroy(_allocator, cptr);
+    alloc_traits::deallocate(_allocator, cptr, 1);
+}
+
+// aggregates the counters of all handles (including released ones)
+template <class T, class D, class A, size_t hs>
+reclamation_stats quiescent_manager<T, D, A, hs>::get_stats() const
+{
+    reclamation_stats stats;
+    for (int i = _handles.max_id(); i >= 0; --i)
+        mark::clear(_handles.load(i))->_stats.add_to(stats);
+    return stats;
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::print() const
+{
+    otm::out() << "quiescent manager print: epoch "
+               << _epoch.load(memo::acquire) << ", "
+               << _handles.max_id() + 1 << "handles" << std::endl;
+}
+
+// advances the epoch if all active handles announced it, returns the
+// (possibly new) epoch
+template <class T, class D, class A, size_t hs>
+uint64_t quiescent_manager<T, D, A, hs>::try_advance(uint64_t epoch)
+{
+    for (int i = _handles.max_id(); i >= 0; --i)
+    {
+        auto temp_handle = _handles.load(i);
+        if (mark::get_mark<0>(temp_handle)) continue;
+        auto announced = temp_handle->_announced.load(memo::acquire);
+        if (announced && announced != epoch) return epoch;
+    }
+    if (_epoch.compare_exchange_strong(epoch, epoch + 1, memo::seq_cst))
+        return epoch + 1;
+    return epoch; // updated by the failed exchange
+}
+
+
+
+
+// *** HANDLE **************************************************************
+// ***** HANDLE CONSTRUCTORS ***********************************************
+template <class T, class D, class A, size_t hs>
+quiescent_manager<T, D, A, hs>::handle_type::handle_type(
+    parent_type& parent, internal_handle& internal, int id)
+    : _parent(parent), _internal(internal), _id(id)
+{
+    _internal._announced.store(_parent._epoch.load(memo::seq_cst),
+                               memo::seq_cst);
+}
+
+template <class T, class D, class A, size_t hs>
+quiescent_manager<T, D, A, hs>::handle_type::handle_type(
+    handle_type&& source) noexcept
+    : _parent(source._parent), _internal(source._internal), _id(source._id)
+{
+    source._id = -1;
+}
+
+template <class T, class D, class A, size_t hs>
+typename quiescent_manager<T, D, A, hs>::handle_type&
+quiescent_manager<T, D, A, hs>::handle_type::operator=(
+    handle_type&& source) noexcept
+{
+    if (&source == this) return *this;
+    this->handle_type::~handle_type();
+    new (this) handle_type(std::move(source));
+    return *this;
+}
+
+// remaining elements stay with the internal handle (until it is reused, or
+// the manager is destroyed)
+template <class T, class D, class A, size_t hs>
+quiescent_manager<T, D, A, hs>::handle_type::~handle_type()
+{
+    if (_id < 0) return;
+
+    quiescent();
+    _internal._announced.store(0, memo::release);
+    _parent._handles.release(_id, &_internal);
+}
+
+
+
+// ***** HANDLE FUNCTIONALITY **********************************************
+template <class T, class D, class A, size_t hs>
+template <class... Args>
+T* quiescent_manager<T, D, A, hs>::handle_type::create_pointer(
+    Args&&... args) const
+{
+    auto temp = alloc_traits::allocate(_parent._allocator, 1);
+    alloc_traits::construct(_parent._allocator, temp,
+                            std::forward<Args>(args)...);
+    return temp;
+}
+
+template <class T, class D, class A, size_t hs>
+T* quiescent_manager<T, D, A, hs>::handle_type::protect(
+    const atomic_pointer_type& ptr) const
+{
+    return ptr.load(memo::acquire);
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::protect_raw(
+    pointer_type) const
+{
+    return;
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::unprotect(pointer_type) const
+{
+    return;
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::unprotect(
+    std::vector<pointer_type>&) const
+{
+    return;
+}
+
+template <class T, class D, class A, size_t hs>
+typename quiescent_manager<T, D, A, hs>::handle_type::guard_type
+quiescent_manager<T, D, A, hs>::handle_type::guard(
+    const atomic_pointer_type& aptr)
+{
+    return make_rec_guard(*this, aptr);
+}
+
+template <class T, class D, class A, size_t hs>
+typename quiescent_manager<T, D, A, hs>::handle_type::guard_type
+quiescent_manager<T, D, A, hs>::handle_type::guard(pointer_type ptr)
+{
+    return make_rec_guard(*this, ptr);
+}
+
+// the element has to be unlinked before, i.e., the epoch is read afterwards
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::safe_delete(
+    pointer_type ptr)
+{
+    _internal._retired.push_back(
+        {mark::clear(ptr), _parent._epoch.load(memo::seq_cst)});
+    _internal._stats.retire(_internal._retired.size());
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::delete_raw(
+    pointer_type ptr)
+{
+    _parent.delete_raw(ptr);
+}
+
+template <class T, class D, class A, size_t hs>
+bool quiescent_manager<T, D, A, hs>::handle_type::is_safe(pointer_type)
+{
+    return false;
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::quiescent()
+{
+    // all previous accesses have to be finished before the announcement
+    std::atomic_thread_fence(memo::seq_cst);
+    auto epoch = _parent._epoch.load(memo::seq_cst);
+    if (_internal._announced.load(memo::relaxed) != epoch)
+        _internal._announced.store(epoch, memo::seq_cst);
+
+    if (_internal._retired.size() == 0) return;
+    _internal._stats.scan();
+    drain(_parent.try_advance(epoch));
+}
+
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::print() const
+{
+    out_tm::out() << "* print in quiescent reclamation handle "
+                  << _internal._retired.size()
+                  << " pointer flagged for deletion *" << std::endl;
+}
+
+// ***** HANDLE HELPER FUNCTION ********************************************
+template <class T, class D, class A, size_t hs>
+void quiescent_manager<T, D, A, hs>::handle_type::drain(uint64_t epoch)
+{
+    while (_internal._retired.size() &&
+           _internal._retired.begin()->epoch + 2 <= epoch)
+    {
+        auto r = _internal._retired.pop_front();
+        _parent._destructor.destroy(*this, r->ptr);
+        _internal._stats.free();
+    }
+}
+
+} // namespace reclamation_tm
+} // namespace utils_tm
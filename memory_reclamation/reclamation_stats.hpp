@@ -0,0 +1,140 @@
+#pragma once
+
+/*******************************************************************************
+ * reclamation_stats.hpp
+ *
+ * Optional statistics for the reclamation managers.  Like debug_tm::counter,
+ * the counters do nothing unless they are switched on (here by defining
+ * RECLAMATION_STATS).
+ *
+ * reclamation_stats: snapshot of the counters (get_stats() of each manager)
+ *   retired     - elements passed to safe_delete
+ *   freed       - elements passed to the destructor (after safe_delete)
+ *   pending     - retired but not yet freed elements (retired - freed)
+ *   scans       - number of (attempted) reclamation passes, e.g., hazard
+ *                 scans or epoch advancements
+ *   max_backlog - largest number of elements held back by one handle (only
+ *                 for managers with local retire lists, 0 otherwise)
+ * stats_counter: counters of one handle (or one manager), they are written
+ *   with relaxed atomics, thus, they can be aggregated concurrently
+ ******************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+#include "../output.hpp"
+
+namespace utils_tm
+{
+namespace reclamation_tm
+{
+
+#ifdef RECLAMATION_STATS
+constexpr bool stats_mode = true;
+#else
+constexpr bool stats_mode = false;
+#endif
+
+struct reclamation_stats
+{
+    size_t retired     = 0;
+    size_t freed       = 0;
+    size_t scans       = 0;
+    size_t max_backlog = 0;
+
+    // counters are read one by one, i.e., freed can overtake retired
+    size_t pending() const { return (retired > freed) ? retired - freed : 0; }
+
+    reclamation_stats& operator+=(const reclamation_stats& rhs)
+    {
+        retired += rhs.retired;
+        freed += rhs.freed;
+        scans += rhs.scans;
+        max_backlog = (max_backlog < rhs.max_backlog) ? rhs.max_backlog
+                                                      : max_backlog;
+        return *this;
+    }
+
+    void print() const
+    {
+        out_tm::out() << "* reclamation stats: retired " << retired
+                      << ", freed " << freed << ", pending " << pending()
+                      << ", scans " << scans << ", max backlog "
+                      << max_backlog << " *" << std::endl;
+    }
+};
+
+class atomic_stats_counter
+{
+  public:
+    atomic_stats_counter() : _retired(0), _freed(0), _scans(0), _backlog(0) {}
+    // only used when managers are moved (no concurrent accesses)
+    atomic_stats_counter(const atomic_stats_counter& other)
+        : _retired(other._retired.load(std::memory_order_relaxed)),
+          _freed(other._freed.load(std::memory_order_relaxed)),
+          _scans(other._scans.load(std::memory_order_relaxed)),
+          _backlog(other._backlog.load(std::memory_order_relaxed))
+    {
+    }
+    atomic_stats_counter& operator=(const atomic_stats_counter& other)
+    {
+        _retired.store(other._retired.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+        _freed.store(other._freed.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+        _scans.store(other._scans.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+        _backlog.store(other._backlog.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+        return *this;
+    }
+
+    inline void retire(size_t backlog = 0)
+    {
+        _retired.fetch_add(1, std::memory_order_relaxed);
+        auto temp = _backlog.load(std::memory_order_relaxed);
+        while (temp < backlog &&
+               !_backlog.compare_exchange_weak(temp, backlog,
+                                               std::memory_order_relaxed))
+        { /* retry */
+        }
+    }
+    inline void free(size_t n = 1)
+    {
+        _freed.fetch_add(n, std::memory_order_relaxed);
+    }
+    inline void scan() { _scans.fetch_add(1, std::memory_order_relaxed); }
+
+    inline void add_to(reclamation_stats& stats) const
+    {
+        reclamation_stats temp;
+        temp.retired     = _retired.load(std::memory_order_relaxed);
+        temp.freed       = _freed.load(std::memory_order_relaxed);
+        temp.scans       = _scans.load(std::memory_order_relaxed);
+        temp.max_backlog = _backlog.load(std::memory_order_relaxed);
+        stats += temp;
+    }
+
+  private:
+    std::atomic_size_t _retired;
+    std::atomic_size_t _freed;
+    std::atomic_size_t _scans;
+    std::atomic_size_t _backlog;
+};
+
+class dummy_stats_counter
+{
+  public:
+    inline void retire(size_t = 0) {}
+    inline void free(size_t = 1) {}
+    inline void scan() {}
+    inline void add_to(reclamation_stats&) const {}
+};
+
+using stats_counter = std::conditional<stats_mode,
+                                       atomic_stats_counter,
+                                       dummy_stats_counter>::type;
+
+} // namespace reclamation_tm
+} // namespace utils_tm
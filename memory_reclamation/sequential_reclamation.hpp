@@ -10,6 +10,7 @@
 
 #include "default_destructor.hpp"
 #include "reclamation_guard.hpp"
+#include "reclamation_stats.hpp"
 
 namespace utils_tm
 {
@@ -20,7 +21,7 @@ template <class T, class D = default_destructor<T>, class A = std::allocator<T>>
 class sequential_manager
 {
   public:
-    using this_type       = sequential_manager<T, A>;
+    using this_type       = sequential_manager<T, D, A>;
     using destructor_type = D;
     using allocator_type  = typename std::allocator_traits<A>::rebind_alloc<T>;
     using alloc_traits    = std::allocator_traits<allocator_type>;
@@ -28,10 +29,12 @@ class sequential_manager
     using atomic_pointer_type = std::atomic<T*>;
     using protected_type      = T;
 
-    template <class lT = T, class lD = default_destructor<T>, class lA = A>
+    template <class lT = T,
+              class lD = rebind_destructor<D, lT>,
+              class lA = A>
     struct rebind
     {
-        using other = sequential_manager<lT, A>;
+        using other = sequential_manager<lT, lD, lA>;
     };
 
     sequential_manager(destructor_type&& destructor = {},
@@ -48,7 +51,7 @@ class sequential_manager
     class handle_type
     {
       private:
-        using parent_type = sequential_manager<T, A>;
+        using parent_type = sequential_manager<T, D, A>;
         using this_type   = handle_type;
 
       public:
@@ -86,6 +89,7 @@ class sequential_manager
 
     [[no_unique_address]] destructor_type _destructor;
     [[no_unique_address]] allocator_type  _allocator;
+    [[no_unique_address]] stats_counter   _stats;
 
     void delete_raw(pointer_type ptr)
     {
@@ -93,7 +97,13 @@ class sequential_manager
         alloc_traits::destroy(_allocator, cptr);
         alloc_traits::deallocate(_allocator, cptr, 1);
     }
-    handle_type get_handle() { return handle_type(_allocator); }
+    handle_type       get_handle() { return handle_type(*this); }
+    reclamation_stats get_stats() const
+    {
+        reclamation_stats stats;
+        _stats.add_to(stats);
+        return stats;
+    }
 };
 
 
@@ -126,7 +136,9 @@ void sequential_manager<T, D, A>::handle_type::safe_delete(pointer_type ptr)
     // alloc_traits::destroy(_allocator, cptr);
     // alloc_traits::deallocate(_allocator, cptr, 1);
 
+    _parent._stats.retire();
     _parent._destructor.destroy(*this, mark::clear(ptr));
+    _parent._stats.free();
 
     // delete mark::clear(ptr);
 }
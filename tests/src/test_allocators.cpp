@@ -16,6 +16,7 @@ using c       = otm::color;
 
 
 #include "allocators/aligned_alloc.hpp"
+#include "allocators/node_pool_alloc.hpp"
 
 #ifndef NO_TBB
 #define TBB_PREVIEW_MEMORY_POOL 1
@@ -40,8 +41,9 @@ void print_help()
                << c::magenta + "* Test subjects\n"
                << "   "
                << c::green +
-                      "aligned_allocator, jemallocator, tbb_pool_allocator, "
-                      "std::allocator, tbb::scalable_allocator\n"
+                      "aligned_allocator, node_pool_allocator, jemallocator, "
+                      "tbb_pool_allocator, std::allocator, "
+                      "tbb::scalable_allocator\n"
                << "   from " << c::yellow + "allocators/"
                << "\n"
                << c::magenta + "* Process\n"
@@ -137,6 +139,8 @@ using aligned_test =
 template <class ThreadType>
 using small_aligned_test = test<atm::aligned_allocator<value_type, 8>,
                                 ThreadType>; // smaller alignment
+template <class ThreadType>
+using node_pool_test = test<atm::node_pool_allocator<value_type>, ThreadType>;
 
 #ifndef NO_TBB
 template <class ThreadType>
@@ -192,6 +196,11 @@ int main(int argn, char** argc)
                << std::endl;
     ttm::start_threads<small_aligned_test>(p, it, n);
 
+    otm::out() << std::endl                                        //
+               << otm::color::bblue + "# NODE_POOL_ALLOCATOR TEST" //
+               << std::endl;
+    ttm::start_threads<node_pool_test>(p, it, n);
+
 
 
 #ifndef NO_TBB
@@ -1,10 +1,13 @@
+#include <iterator>
 #include <random>
 #include <string>
+#include <vector>
 
 #include "command_line_parser.hpp"
 #include "output.hpp"
 
 #include "data_structures/circular_buffer.hpp"
+#include "data_structures/static_circular_buffer.hpp"
 
 namespace utm = utils_tm;
 namespace otm = utils_tm::out_tm;
@@ -24,6 +27,18 @@ class move_checker
     bool operator!=(const move_checker& other) { return !operator==(other); }
 };
 
+// not trivially copyable, i.e., elements have to be moved individually
+class string_checker
+{
+  public:
+    std::string str;
+
+    string_checker(size_t i = 0) : str(std::to_string(i)) {}
+
+    bool operator==(const string_checker& other) { return other.str == str; }
+    bool operator!=(const string_checker& other) { return !operator==(other); }
+};
+
 void generate_random(size_t n, std::vector<size_t>& container)
 {
     std::mt19937_64                       re;
@@ -92,6 +107,166 @@ void run_test(size_t n, size_t c, size_t w)
         otm::out() << otm::color::green + "test fully successful!" << std::endl;
 }
 
+// appends and pops blocks of w elements, such that the contents wrap around
+template <class T>
+void run_bulk_test(size_t n, size_t c, size_t w)
+{
+    std::vector<size_t> input;
+    input.reserve(n);
+    generate_random(n, input);
+
+    utm::circular_buffer<T> container{c};
+    size_t                  trailing_index = 0;
+    bool                    noerror        = true;
+    std::vector<T>          block;
+    std::vector<T>          popped;
+
+    for (size_t i = 0; i < n; i += w)
+    {
+        block.clear();
+        for (size_t j = i; j < std::min(i + w, n); ++j)
+            block.emplace_back(input[j]);
+        container.append(std::make_move_iterator(block.begin()),
+                         std::make_move_iterator(block.end()));
+
+        // the spans have to contain all elements in order
+        auto [first, second] = container.as_spans();
+        if (first.size() + second.size() != container.size())
+        {
+            noerror = false;
+            otm::out() << otm::color::red + "in bulk: wrong span sizes at pos "
+                       << i << std::endl;
+        }
+        size_t k = trailing_index;
+        for (auto& e : first)
+            if (e != T(input[k++])) noerror = false;
+        for (auto& e : second)
+            if (e != T(input[k++])) noerror = false;
+
+        popped.clear();
+        auto npopped =
+            container.pop_front_n(std::back_inserter(popped), w / 2 + 1);
+        if (npopped != popped.size() ||
+            npopped != std::min(w / 2 + 1, k - trailing_index))
+        {
+            noerror = false;
+            otm::out() << otm::color::red + "in bulk: wrong pop count at pos "
+                       << i << std::endl;
+        }
+        for (auto& e : popped)
+        {
+            if (e != T(input[trailing_index++]))
+            {
+                noerror = false;
+                otm::out() << otm::color::red +
+                                  "in bulk: popped the wrong nmbr at pos "
+                           << i << std::endl;
+            }
+        }
+    }
+
+    popped.clear();
+    container.pop_front_n(std::back_inserter(popped), n);
+    if (trailing_index + popped.size() != n || container.size())
+    {
+        noerror = false;
+        otm::out() << otm::color::red + "in bulk: elements missing at the end"
+                   << std::endl;
+    }
+
+    otm::out() << "capacity after bulk test: " << container.capacity()
+               << std::endl;
+
+    if (noerror)
+        otm::out() << otm::color::green + "test fully successful!" << std::endl;
+}
+
+// same as run_test, but the buffer has a fixed capacity, i.e., pushes have to
+// fail once it is full (window w is chosen by the capacity)
+template <class T>
+void run_static_test(size_t n)
+{
+    std::vector<size_t> input;
+    input.reserve(n);
+    generate_random(n, input);
+
+    utm::static_circular_buffer<T, 48> container;
+    size_t                             w              = container.capacity();
+    size_t                             trailing_index = 0;
+    bool                               noerror        = true;
+
+    for (size_t i = 0; i < w; i++) { container.emplace_back(input[i]); }
+    if (container.emplace_back(input[w]) || container.emplace_front(input[w]))
+    {
+        noerror = false;
+        otm::out() << otm::color::red + "in static: push into a full buffer"
+                   << std::endl;
+    }
+
+    for (size_t i = w; i < n; i++)
+    {
+        auto popped = container.pop_front();
+        if (!popped || popped.value() != T(input[trailing_index++]))
+        {
+            noerror = false;
+            otm::out() << otm::color::red +
+                              "in static: popped the wrong nmbr at pos "
+                       << i << std::endl;
+        }
+        container.emplace_back(input[i]);
+    }
+    trailing_index = n - 1;
+    for (size_t i = n - w - 1; i > 0; i--)
+    {
+        auto popped = container.pop_back();
+        if (!popped || popped.value() != T(input[trailing_index--]))
+        {
+            noerror = false;
+            otm::out() << otm::color::red +
+                              "in static: popped the wrong nmbr at pos "
+                       << i << std::endl;
+        }
+        container.emplace_front(input[i]);
+    }
+
+    // the contents are at an arbitrary offset, check spans and bulk ops
+    std::vector<T> popped;
+    container.pop_front_n(std::back_inserter(popped), w / 3);
+    auto copy = std::move(container);
+    auto [first, second] = copy.as_spans();
+    if (first.size() + second.size() != w - w / 3 || container.size())
+    {
+        noerror = false;
+        otm::out() << otm::color::red + "in static: wrong size after move"
+                   << std::endl;
+    }
+    size_t nappended = copy.append(std::make_move_iterator(popped.begin()),
+                                   std::make_move_iterator(popped.end()));
+    if (nappended != w / 3 || !copy.full())
+    {
+        noerror = false;
+        otm::out() << otm::color::red + "in static: wrong append count"
+                   << std::endl;
+    }
+    for (size_t i = 0; i < w; ++i)
+    {
+        size_t k = (i < w - w / 3) ? w / 3 + i + 1 : i - (w - w / 3) + 1;
+        if (copy.begin()[i] != T(input[k]))
+        {
+            noerror = false;
+            otm::out() << otm::color::red +
+                              "in static: wrong element after append at pos "
+                       << i << std::endl;
+        }
+    }
+
+    otm::out() << "capacity of static buffer: " << copy.capacity()
+               << std::endl;
+
+    if (noerror)
+        otm::out() << otm::color::green + "test fully successful!" << std::endl;
+}
+
 
 int main(int argn, char** argc)
 {
@@ -113,12 +288,16 @@ int main(int argn, char** argc)
                << "  1. randomly generate keys" << std::endl
                << "  2. push_front and pop_back" << std::endl
                << "  3. push_back and pop_front" << std::endl
+               << "  4. append and pop_front_n blocks" << std::endl
+               << "  5. the same with a static_circular_buffer" << std::endl
                << otm::color::reset << std::endl;
 
 
     otm::out() << otm::color::bgreen + "START TEST with <size_t>" << std::endl;
 
     run_test<size_t>(n, c, w);
+    run_bulk_test<size_t>(n, c, w);
+    run_static_test<size_t>(n);
 
     // otm::out() << otm::color::bgreen << "START TEST with <std::string>"
     //            << otm::color::reset << std::endl;
@@ -129,6 +308,15 @@ int main(int argn, char** argc)
                << std::endl;
 
     run_test<move_checker>(n, c, w);
+    run_bulk_test<move_checker>(n, c, w);
+    run_static_test<move_checker>(n);
+
+    otm::out() << otm::color::bgreen + "START TEST with <string_checker>"
+               << std::endl;
+
+    run_test<string_checker>(n, c, w);
+    run_bulk_test<string_checker>(n, c, w);
+    run_static_test<string_checker>(n);
 
     otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
 
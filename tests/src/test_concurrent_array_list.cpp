@@ -0,0 +1,110 @@
+#include <atomic>
+
+#include "command_line_parser.hpp"
+#include "data_structures/concurrent_array_list.hpp"
+#include "output.hpp"
+#include "pin_thread.hpp"
+#include "thread_coordination.hpp"
+
+namespace utm = utils_tm;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+using list_type = utm::concurrent_array_list<std::pair<size_t, size_t>,
+                                             std::allocator<size_t>, 256>;
+alignas(64) static list_type         list;
+alignas(64) static std::atomic_size_t errors;
+
+template <class ThreadType>
+struct test
+{
+    static int execute(ThreadType thrd, size_t n, size_t it)
+    {
+        utm::pin_to_core(thrd.id);
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            if constexpr (thrd.is_main) { list = list_type(); }
+
+            thrd.synchronized([&thrd, n]() {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    list.emplace_back(i, thrd.id);
+                }
+                return 0;
+            });
+
+            // iterating is only allowed once all appends are finished
+            thrd.synchronized([&thrd, n]() {
+                size_t lerrors = 0;
+                size_t next    = 0;
+                for (auto it = list.begin(); it != list.end(); ++it)
+                {
+                    auto [current, p] = *it;
+                    if (p == thrd.id && current != next++)
+                    {
+                        lerrors++;
+                        otm::out() << "Wrong order?" << std::endl;
+                    }
+                }
+                if (next != n)
+                {
+                    otm::out() << "Thread " << thrd.id
+                               << " not all elements found?" << std::endl;
+                    lerrors++;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            if (thrd.is_main && list.size() != thrd.p * n)
+            {
+                thrd.out << "Unexpected Size " << list.size() << "(expected "
+                         << thrd.p * n << ")" << std::endl;
+                errors.fetch_add(1);
+            }
+
+            if (!errors.load())
+            {
+                thrd.out << otm::color::green + "Test fully successful!"
+                         << std::endl;
+            }
+            else
+            {
+                thrd.out << otm::color::red + "Test unsuccessful!" << std::endl;
+            }
+        }
+
+        return 0;
+    }
+};
+
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c{argn, argc};
+    size_t                   n  = c.int_arg("-n", 1000000);
+    size_t                   p  = c.int_arg("-p", 4);
+    size_t                   it = c.int_arg("-it", 8);
+
+    otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
+    otm::out() << "testing: concurrent_array_list" << std::endl;
+
+
+    otm::out() << "All threads append increasing elements into the list."
+               << std::endl
+               << "Then iterate through all inserted elements. Test weather"
+               << std::endl
+               << "each thread inserted all its elements in order." << std::endl
+               << otm::color::bblue << "  1. each thread appends n elements"
+               << std::endl
+               << "  2. each thread iterates over elements and finds its own"
+               << std::endl;
+
+
+    otm::out() << otm::color::bgreen + "START TEST" << std::endl;
+    ttm::start_threads<test>(p, n, it);
+    otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <atomic>
+#include <string>
+
+#include "command_line_parser.hpp"
+#include "data_structures/concurrent_skip_list.hpp"
+#include "output.hpp"
+#include "pin_thread.hpp"
+#include "thread_coordination.hpp"
+
+namespace utm = utils_tm;
+namespace rtm = utils_tm::reclamation_tm;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+using list_type     = utm::concurrent_skip_list<size_t>;
+using rec_mngr_type = typename list_type::reclamation_manager_type;
+
+alignas(64) static list_type*         list;
+alignas(64) static rec_mngr_type      rec_mngr;
+alignas(64) static std::atomic_size_t errors;
+alignas(64) static std::atomic_size_t successes;
+
+std::string size_test(size_t exp, size_t real)
+{
+    if (exp == real) return "";
+    errors.fetch_add(1);
+    std::string str = "Unexpected Size! expected " + std::to_string(exp) +
+                      " found " + std::to_string(real) + "\n";
+    return str;
+}
+
+// visits the keys of one thread in a scattered order
+inline size_t key(size_t i, size_t n, size_t id, size_t p)
+{
+    return ((i * 7919) % n) * p + id;
+}
+
+template <class ThreadType>
+struct test
+{
+    static int execute(ThreadType thrd, size_t n, size_t it)
+    {
+        utm::pin_to_core(thrd.id);
+        auto rec_handle = rec_mngr.get_handle();
+        auto p          = thrd.p;
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            if constexpr (thrd.is_main)
+            {
+                list = new list_type();
+                errors.store(0);
+                successes.store(0);
+            }
+
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (!list->insert(rec_handle, key(i, n, thrd.id, p)))
+                        ++lerrors;
+                }
+                // all keys are present -> no duplicates
+                for (size_t i = 0; i < n; i += 7)
+                {
+                    if (list->insert(rec_handle, key(i, n, thrd.id, p)))
+                        ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            // the list has to be sorted and has to contain every element
+            if (thrd.is_main)
+            {
+                size_t next = 0;
+                for (auto it = list->begin(rec_handle);
+                     it != list->end(rec_handle); ++it)
+                {
+                    if (*it != next++) errors.fetch_add(1);
+                }
+                if (next != n * p) errors.fetch_add(1);
+            }
+            thrd.out << size_test(p * n, list->size(rec_handle))
+                     << (!errors.load() ? "Insert test successful!"
+                                        : "Insert test unsuccessful!")
+                     << std::endl;
+
+            // erase all even keys, while checking that odd ones remain
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    auto k = key(i, n, thrd.id, p);
+                    if (k & 1)
+                    {
+                        if (list->find(rec_handle, k) == list->end(rec_handle))
+                            ++lerrors;
+                    }
+                    else if (!list->erase(rec_handle, k))
+                        ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            thrd.out << size_test(p * n - (p * n + 1) / 2,
+                                  list->size(rec_handle))
+                     << (!errors.load() ? "Erase test successful!"
+                                        : "Erase test unsuccessful!")
+                     << std::endl;
+
+            // range queries see exactly the odd keys of the range
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    auto k = key(i, n, thrd.id, p);
+                    if (list->contains(rec_handle, k) != bool(k & 1))
+                        ++lerrors;
+                }
+                for (size_t start = thrd.id; start + 16 < n * p;
+                     start += 101 * p)
+                {
+                    size_t next = start | 1;
+                    for (auto it = list->lower_bound(rec_handle, start);
+                         it != list->end(rec_handle) && *it < start + 16; ++it)
+                    {
+                        if (*it != next) ++lerrors;
+                        next += 2;
+                    }
+                    if (next < start + 16) ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            thrd.out << (!errors.load() ? "Range test successful!"
+                                        : "Range test unsuccessful!")
+                     << std::endl;
+
+            // all threads compete for the same even keys
+            thrd.synchronized([&rec_handle, n]() {
+                size_t lsuccesses = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    lsuccesses += list->insert(rec_handle, 2 * i);
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    lsuccesses += list->erase(rec_handle, 2 * i);
+                }
+                successes.fetch_add(lsuccesses, std::memory_order_release);
+                return 0;
+            });
+
+            // every key was inserted at least once and erased exactly as
+            // often as it was inserted
+            if (thrd.is_main)
+            {
+                auto s = successes.load();
+                if (s < 2 * n || s & 1) errors.fetch_add(1);
+                thrd.out << size_test(p * n - (p * n + 1) / 2,
+                                      list->size(rec_handle));
+                thrd.out << (!errors.load() ? "Contention test successful!"
+                                            : "Contention test unsuccessful!")
+                         << std::endl;
+            }
+
+            // iterations run concurrently to the erasure of even keys, they
+            // have to see every odd key (in ascending order)
+            thrd.synchronized([&rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t r = 0; r < 8; ++r)
+                {
+                    for (size_t i = r; i < n; i += 8)
+                    {
+                        list->insert(rec_handle, 2 * i);
+                        list->erase(rec_handle, 2 * i);
+                    }
+
+                    size_t odd   = 0;
+                    size_t last  = 0;
+                    bool   first = true;
+                    for (auto it = list->begin(rec_handle);
+                         it != list->end(rec_handle); ++it)
+                    {
+                        if (!first && *it <= last) ++lerrors;
+                        first = false;
+                        last  = *it;
+                        odd += *it & 1;
+                    }
+                    if (odd != p * n / 2) ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            thrd.out << size_test(p * n / 2, list->size(rec_handle))
+                     << (!errors.load() ? "Iteration test successful!"
+                                        : "Iteration test unsuccessful!")
+                     << std::endl;
+
+            if (!errors.load())
+            {
+                thrd.out << otm::color::green + "Test fully successful!"
+                         << std::endl;
+            }
+            else
+            {
+                thrd.out << otm::color::red + "Test unsuccessful!" << std::endl;
+            }
+
+            thrd.synchronized([]() { return 0; });
+            if constexpr (thrd.is_main) { delete list; }
+        }
+
+        return 0;
+    }
+};
+
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c{argn, argc};
+    size_t                   n  = c.int_arg("-n", 10000);
+    size_t                   p  = c.int_arg("-p", 4);
+    size_t                   it = c.int_arg("-it", 8);
+
+    otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
+    otm::out() << "testing: concurrent_skip_list" << std::endl;
+
+
+    otm::out() << "All threads insert disjoint keys in a scattered order."
+               << std::endl
+               << "Then test that the list is sorted, that erased keys are"
+               << std::endl
+               << "gone, and that range queries find exactly the rest."
+               << std::endl
+               << otm::color::bblue //
+               << "  1. each thread inserts n elements" << std::endl
+               << "  2. each thread erases its even elements" << std::endl
+               << "  3. each thread looks for all its elements and ranges"
+               << std::endl
+               << "  4. all threads insert and erase the same even keys"
+               << std::endl
+               << "  5. all threads iterate while even keys are erased"
+               << std::endl;
+
+
+    otm::out() << otm::color::bgreen + "START TEST" << std::endl;
+    ttm::start_threads<test>(p, n, it);
+    otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <atomic>
+
+#include "command_line_parser.hpp"
+#include "data_structures/concurrent_elimination_stack.hpp"
+#include "output.hpp"
+#include "pin_thread.hpp"
+#include "thread_coordination.hpp"
+
+namespace utm = utils_tm;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+using stack_type =
+    utm::concurrent_elimination_stack<std::pair<size_t, size_t>>;
+using rec_mngr_type = typename stack_type::reclamation_manager_type;
+
+alignas(64) static stack_type*        stack;
+alignas(64) static rec_mngr_type      rec_mngr;
+alignas(64) static std::atomic_size_t errors;
+alignas(64) static std::atomic_size_t popped;
+alignas(64) static std::atomic_size_t popped_sum;
+
+template <class ThreadType>
+struct test
+{
+    static int execute(ThreadType thrd, size_t n, size_t it)
+    {
+        utm::pin_to_core(thrd.id);
+        auto rec_handle = rec_mngr.get_handle();
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            if constexpr (thrd.is_main)
+            {
+                delete stack;
+                stack = new stack_type();
+                popped.store(0);
+                popped_sum.store(0);
+            }
+
+            // alternate pushes and pops to provoke eliminations
+            thrd.synchronized([&rec_handle, n]() {
+                size_t lpopped = 0;
+                size_t lsum    = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    stack->emplace(i, 0);
+                    if (i & 1)
+                    {
+                        auto elem = stack->pop(rec_handle);
+                        if (!elem) continue;
+                        lpopped++;
+                        lsum += elem.value().first;
+                    }
+                }
+                popped.fetch_add(lpopped, std::memory_order_relaxed);
+                popped_sum.fetch_add(lsum, std::memory_order_relaxed);
+                return 0;
+            });
+
+            // pop all remaining elements
+            thrd.synchronized([&rec_handle]() {
+                size_t lpopped = 0;
+                size_t lsum    = 0;
+                while (true)
+                {
+                    auto elem = stack->pop(rec_handle);
+                    if (!elem) break;
+                    lpopped++;
+                    lsum += elem.value().first;
+                }
+                popped.fetch_add(lpopped, std::memory_order_relaxed);
+                popped_sum.fetch_add(lsum, std::memory_order_relaxed);
+                return 0;
+            });
+
+            if (thrd.is_main &&
+                (popped.load() != thrd.p * n ||
+                 popped_sum.load() != thrd.p * (n * (n - 1) / 2) ||
+                 stack->size() != 0))
+            {
+                thrd.out << "Unexpected pop result " << popped.load()
+                         << " elements (expected " << thrd.p * n << ")"
+                         << std::endl;
+                errors.fetch_add(1);
+            }
+
+            if (!errors.load())
+            {
+                thrd.out << otm::color::green + "Test fully successful!"
+                         << std::endl;
+            }
+            else
+            {
+                thrd.out << otm::color::red + "Test unsuccessful!" << std::endl;
+            }
+        }
+
+        if constexpr (thrd.is_main)
+        {
+            delete stack;
+            stack = nullptr;
+        }
+        return 0;
+    }
+};
+
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c{argn, argc};
+    size_t                   n  = c.int_arg("-n", 1000000);
+    size_t                   p  = c.int_arg("-p", 4);
+    size_t                   it = c.int_arg("-it", 8);
+
+    otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
+    otm::out() << "testing: concurrent_elimination_stack" << std::endl;
+
+
+    otm::out() << "All threads push and pop elements concurrently." << std::endl
+               << "Then the remaining elements are popped. Test weather"
+               << std::endl
+               << "each element was popped exactly once." << std::endl
+               << otm::color::bblue
+               << "  1. each thread pushes n elements (popping every second)"
+               << std::endl
+               << "  2. all threads pop the remaining elements" << std::endl;
+
+
+    otm::out() << otm::color::bgreen + "START TEST" << std::endl;
+    ttm::start_threads<test>(p, n, it);
+    otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <atomic>
+#include <string>
 
 #include "command_line_parser.hpp"
 #include "data_structures/many_producer_single_consumer_buffer.hpp"
@@ -10,23 +11,41 @@ namespace utm = utils_tm;
 namespace otm = utils_tm::out_tm;
 namespace ttm = utils_tm::thread_tm;
 
-alignas(64) static utm::many_producer_single_consumer_buffer<size_t> buffer{0};
+template <class Buffer>
+alignas(64) static Buffer buffer{0};
 
-template <class ThreadType>
+// elements are either numbers, or numbers written into strings
+template <class T>
+T make_element(size_t i)
+{
+    return T(i);
+}
+template <>
+std::string make_element<std::string>(size_t i)
+{
+    return std::to_string(i);
+}
+size_t element_index(size_t e) { return e; }
+size_t element_index(const std::string& e) { return std::stoul(e); }
+
+template <class Buffer, class ThreadType>
 struct test;
 
-template <>
-struct test<ttm::untimed_sub_thread>
+template <class Buffer>
+struct test<Buffer, ttm::untimed_sub_thread>
 {
-    static int execute(ttm::untimed_sub_thread thrd, size_t n, size_t)
+    static int
+    execute(ttm::untimed_sub_thread thrd, size_t n, size_t, size_t, bool)
     {
         utm::pin_to_core(thrd.id);
+        using value_type = typename Buffer::value_type;
 
         thrd.synchronized([n]() {
             size_t npushed = 0;
             for (size_t i = 1; i <= n; ++i)
             {
-                while (!buffer.push_back(i))
+                auto e = make_element<value_type>(i);
+                while (!buffer<Buffer>.push_back(e))
                 { /* try inserting i while the buffer is full */
                 }
                 npushed++;
@@ -39,25 +58,38 @@ struct test<ttm::untimed_sub_thread>
     }
 };
 
-template <>
-struct test<ttm::timed_main_thread>
+template <class Buffer>
+struct test<Buffer, ttm::timed_main_thread>
 {
-    static int execute(ttm::timed_main_thread thrd, size_t n, size_t bsize)
+    static int execute(ttm::timed_main_thread thrd,
+                       size_t                 n,
+                       size_t                 bsize,
+                       size_t                 gsize,
+                       bool                   bulk)
     {
         utm::pin_to_core(thrd.id);
-        buffer = utm::many_producer_single_consumer_buffer<size_t>{bsize};
+        buffer<Buffer>  = Buffer{bsize, gsize};
         size_t* counter = new size_t[n + 1];
-        std::fill(counter, counter + n, 0);
+        std::fill(counter, counter + n + 1, 0);
 
-        thrd.synchronized([&thrd, n, counter]() {
+        thrd.synchronized([&thrd, n, bulk, counter]() {
             size_t npopped = 0;
             while (counter[n] < thrd.p - 1)
             {
-                auto popped = buffer.pop();
+                if (bulk)
+                {
+                    for (const auto& e : buffer<Buffer>.pull_all())
+                    {
+                        ++npopped;
+                        counter[element_index(e)]++;
+                    }
+                    continue;
+                }
+                auto popped = buffer<Buffer>.pop();
                 if (popped)
                 {
                     ++npopped;
-                    counter[popped.value()]++;
+                    counter[element_index(popped.value())]++;
                 }
             }
             otm::buffered_out() << npopped << " elements popped" << std::endl;
@@ -80,11 +112,27 @@ struct test<ttm::timed_main_thread>
         if (noerror)
             otm::buffered_out()
                 << otm::color::green + "test fully successful" << std::endl;
+        otm::buffered_out() << "capacity after test: "
+                            << buffer<Buffer>.capacity() << std::endl;
+        delete[] counter;
 
         return 0;
     }
 };
 
+// only pointers use the dummy slot (with nullptr), T() is a valid element for
+// all other types
+static_assert(utm::mpsc_use_dummy_slot<void*>());
+static_assert(!utm::mpsc_use_dummy_slot<size_t>());
+static_assert(!utm::mpsc_use_dummy_slot<std::string>());
+
+template <class ThreadType>
+using atomic_test =
+    test<utm::many_producer_single_consumer_buffer<size_t>, ThreadType>;
+template <class ThreadType>
+using string_test =
+    test<utm::auto_many_producer_single_consumer_buffer<std::string>,
+         ThreadType>;
 
 int main(int argn, char** argc)
 {
@@ -92,6 +140,7 @@ int main(int argn, char** argc)
     size_t                   n     = c.int_arg("-n", 1000000);
     size_t                   bsize = c.int_arg("-s", 1000);
     size_t                   p     = c.int_arg("-p", 3);
+    size_t                   gsize = c.int_arg("-g", 64 * bsize);
 
     otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
     otm::out() << "testing: many_producer_single_consumer_buffer" << std::endl;
@@ -109,12 +158,30 @@ int main(int argn, char** argc)
         << "  1b. wait for synchronized operation\n"
         << "  2a. pop elements and count appearances from each number\n"
         << "  2b. push back elements repeatedly, until 0..n are inserted\n"
-        << "      by each thread" << std::endl
+        << "      by each thread\n"
+        << "  3.  repeat with a buffer that grows up to -g elements\n"
+        << "  4.  repeat, popping with pull_all instead of pop\n"
+        << "  5.  repeat 3. and 4. with std::string elements" << std::endl
         << otm::color::reset << std::endl;
 
 
     otm::out() << otm::color::bgreen + "START TEST with <size_t>" << std::endl;
-    ttm::start_threads<test>(p, n, bsize);
+    ttm::start_threads<atomic_test>(p, n, bsize, bsize, false);
+
+    otm::out() << otm::color::bgreen + "START TEST with growing buffer"
+               << std::endl;
+    ttm::start_threads<atomic_test>(p, n, bsize, gsize, false);
+
+    otm::out() << otm::color::bgreen + "START TEST with pull_all" << std::endl;
+    ttm::start_threads<atomic_test>(p, n, bsize, gsize, true);
+
+    otm::out() << otm::color::bgreen + "START TEST with <std::string>"
+               << std::endl;
+    ttm::start_threads<string_test>(p, n, bsize, gsize, false);
+
+    otm::out() << otm::color::bgreen + "START TEST with <std::string> pull_all"
+               << std::endl;
+    ttm::start_threads<string_test>(p, n, bsize, gsize, true);
     otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
 
     return 0;
@@ -67,6 +67,21 @@ struct test
                 return 0;
             });
 
+            // the batched snapshot has to see the same elements
+            if (thrd.is_main)
+            {
+                size_t count = 0;
+                for (auto it = queue.snapshot_begin(rec_handle, 64);
+                     it != queue.snapshot_end(rec_handle); ++it)
+                {
+                    if (it->second >= thrd.p || it->first >= n)
+                        errors.fetch_add(1);
+                    ++count;
+                }
+                thrd.out << size_test(thrd.p * n, count)
+                         << size_test(thrd.p * n, queue.approximate_size());
+            }
+
             thrd.out << size_test(thrd.p * n, queue.size(rec_handle))
                      << (!errors.load() ? "Push test successful!"
                                         : "Push test unsuccessful!")
@@ -82,11 +97,28 @@ struct test
                 {
                     if (!queue.erase(rec_handle, std::make_pair(i, thrd.id)))
                         ++lerrors;
+                    // scan the list while other threads are erasing
+                    if (i == n / 2)
+                    {
+                        size_t count = 0;
+                        for (auto it = queue.snapshot_begin(rec_handle, 16);
+                             it != queue.snapshot_end(rec_handle); ++it)
+                        {
+                            if (it->first >= n) ++lerrors;
+                            ++count;
+                        }
+                        if (count > thrd.p * n) ++lerrors;
+                    }
                 }
                 errors.fetch_add(lerrors, std::memory_order_release);
                 return 0;
             });
 
+            if (thrd.is_main)
+            {
+                thrd.out << size_test(0, queue.approximate_size());
+            }
+
             thrd.out << size_test(0, queue.size(rec_handle))
                      << (!errors.load() ? "Erase test successful!"
                                         : "Erase test unsuccessful!")
@@ -0,0 +1,158 @@
+#include <atomic>
+#include <string>
+
+#include "command_line_parser.hpp"
+#include "data_structures/protected_sorted_singly_linked_list.hpp"
+#include "output.hpp"
+#include "pin_thread.hpp"
+#include "thread_coordination.hpp"
+
+namespace utm = utils_tm;
+namespace rtm = utils_tm::reclamation_tm;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+using queue_type    = utm::protected_sorted_singly_linked_list<size_t>;
+using rec_mngr_type = typename queue_type::reclamation_manager_type;
+
+alignas(64) static queue_type         queue;
+alignas(64) static rec_mngr_type      rec_mngr;
+alignas(64) static std::atomic_size_t errors;
+
+std::string size_test(size_t exp, size_t real)
+{
+    if (exp == real) return "";
+    errors.fetch_add(1);
+    std::string str = "Unexpected Size! expected " + std::to_string(exp) +
+                      " found " + std::to_string(real) + "\n";
+    return str;
+}
+
+// visits the keys of one thread in a scattered order
+inline size_t key(size_t i, size_t n, size_t id, size_t p)
+{
+    return ((i * 7919) % n) * p + id;
+}
+
+template <class ThreadType>
+struct test
+{
+    static int execute(ThreadType thrd, size_t n, size_t it)
+    {
+        utm::pin_to_core(thrd.id);
+        auto rec_handle = rec_mngr.get_handle();
+        auto p          = thrd.p;
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            if constexpr (thrd.is_main)
+            {
+                queue = queue_type();
+                errors.store(0);
+            }
+
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    queue.push(rec_handle, key(i, n, thrd.id, p));
+                }
+                return 0;
+            });
+
+            // the list has to be sorted and has to contain every element
+            if (thrd.is_main)
+            {
+                size_t next = 0;
+                for (auto it = queue.begin(rec_handle);
+                     it != queue.end(rec_handle); ++it)
+                {
+                    if (*it != next++) errors.fetch_add(1);
+                }
+                if (next != n * p) errors.fetch_add(1);
+            }
+            thrd.out << size_test(p * n, queue.size(rec_handle))
+                     << (!errors.load() ? "Push test successful!"
+                                        : "Push test unsuccessful!")
+                     << std::endl;
+
+            // erase all even keys, while checking that odd ones remain
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    auto k = key(i, n, thrd.id, p);
+                    if (k & 1)
+                    {
+                        if (queue.push_or_find(rec_handle, k) ==
+                            queue.end(rec_handle))
+                            ++lerrors;
+                    }
+                    else if (!queue.erase(rec_handle, k))
+                        ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            thrd.out << size_test(p * n - (p * n + 1) / 2,
+                                  queue.size(rec_handle))
+                     << (!errors.load() ? "Erase test successful!"
+                                        : "Erase test unsuccessful!")
+                     << std::endl;
+
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    auto k = key(i, n, thrd.id, p);
+                    if (queue.contains(rec_handle, k) != bool(k & 1))
+                        ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            if (!errors.load())
+            {
+                thrd.out << otm::color::green + "Test fully successful!"
+                         << std::endl;
+            }
+            else
+            {
+                thrd.out << otm::color::red + "Test unsuccessful!" << std::endl;
+            }
+        }
+
+        return 0;
+    }
+};
+
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c{argn, argc};
+    size_t                   n  = c.int_arg("-n", 10000);
+    size_t                   p  = c.int_arg("-p", 4);
+    size_t                   it = c.int_arg("-it", 8);
+
+    otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
+    otm::out() << "testing: protected_sorted_singly_linked_list" << std::endl;
+
+
+    otm::out() << "All threads push disjoint keys in a scattered order."
+               << std::endl
+               << "Then test that the list is sorted, and that erased keys"
+               << std::endl
+               << "are gone while all other keys are still found." << std::endl
+               << otm::color::bblue //
+               << "  1. each thread pushes n elements" << std::endl
+               << "  2. each thread erases its even elements" << std::endl
+               << "  3. each thread looks for all its elements" << std::endl;
+
+
+    otm::out() << otm::color::bgreen + "START TEST" << std::endl;
+    ttm::start_threads<test>(p, n, it);
+    otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
+
+    return 0;
+}
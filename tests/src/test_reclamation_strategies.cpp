@@ -1,4 +1,5 @@
 #include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <tuple>
@@ -22,7 +23,9 @@ void print_help()
                << "   tests/src/hazard_test.cpp.\n"
                << c::magenta + "* Test subject\n"
                << "   "
-               << c::green + "hazard_manager, counting_manager, delayed_manager"
+               << c::green + "hazard_manager, indexed_hazard_manager,\n   "
+               << "era_manager, quiescent_manager, counting_manager,\n   "
+               << "delayed_manager, background_reclaimer"
                << " from " << c::yellow + "memory_reclamation/..."
                << "\n"
                << c::magenta + "* Process\n"
@@ -71,9 +74,13 @@ std::atomic_int foo::deleted = -1;
 
 
 
+#include "memory_reclamation/background_reclaimer.hpp"
 #include "memory_reclamation/counting_reclamation.hpp"
 #include "memory_reclamation/delayed_reclamation.hpp"
+#include "memory_reclamation/era_reclamation.hpp"
 #include "memory_reclamation/hazard_reclamation.hpp"
+#include "memory_reclamation/indexed_hazard_reclamation.hpp"
+#include "memory_reclamation/quiescent_reclamation.hpp"
 // This would fail #include "memory_reclamation/sequential_reclamation.hpp"
 
 alignas(64) static std::atomic<foo*> the_one;
@@ -83,6 +90,13 @@ alignas(64) static std::atomic_bool finished{false};
 
 
 
+// announces a quiescent point for managers that need them
+template <class Handle>
+void quiescent(Handle& handle)
+{
+    if constexpr (requires { handle.quiescent(); }) handle.quiescent();
+}
+
 template <class ReclManager, class ThreadType>
 struct test;
 
@@ -125,6 +139,7 @@ struct test<ReclManager, ttm::timed_main_thread>
                                << std::flush;
                 handle.safe_delete(current);
                 current = std::move(next);
+                quiescent(handle);
             }
 
             finished.store(true);
@@ -138,6 +153,16 @@ struct test<ReclManager, ttm::timed_main_thread>
         });
 
         thrd.synchronize();
+
+        if constexpr (rtm::stats_mode)
+        {
+            // only the main thread retires elements
+            auto stats = recl_mngr.get_stats();
+            stats.print();
+            if (stats.retired != it + 1)
+                otm::out() << "Error: unexpected number of retired elements "
+                           << stats.retired << std::endl;
+        }
         return 0;
     }
 };
@@ -157,6 +182,7 @@ struct test<ReclManager, ttm::untimed_sub_thread>
         thrd.synchronized([&handle]() {
             while (!finished.load())
             {
+                quiescent(handle);
                 auto current = handle.guard(the_one);
                 if (!current) continue;
                 for (size_t i = 0; i < 100; ++i) current->counter.fetch_add(1);
@@ -175,8 +201,38 @@ template <class ThreadType>
 using delayed_test = test<rtm::delayed_manager<foo>, ThreadType>;
 template <class ThreadType>
 using counting_test = test<rtm::counting_manager<foo>, ThreadType>;
+using cached_counting_type = rtm::counting_manager<foo,
+                                                   rtm::default_destructor<foo>,
+                                                   std::allocator<foo>,
+                                                   utm::circular_buffer,
+                                                   4,
+                                                   2>;
+template <class ThreadType>
+using cached_counting_test = test<cached_counting_type, ThreadType>;
+// small registry segments, such that handles span multiple segments
+using hazard_type = rtm::
+    hazard_manager<foo, rtm::default_destructor<foo>, std::allocator<foo>, 2>;
+template <class ThreadType>
+using hazard_test = test<hazard_type, ThreadType>;
+using asym_hazard_type =
+    rtm::hazard_manager<foo,
+                        rtm::default_destructor<foo>,
+                        std::allocator<foo>,
+                        64,
+                        256,
+                        utm::concurrency_tm::asymmetric_fence_policy>;
+template <class ThreadType>
+using asym_hazard_test = test<asym_hazard_type, ThreadType>;
+using bg_hazard_type =
+    rtm::hazard_manager<foo, rtm::background_destructor<foo>>;
 template <class ThreadType>
-using hazard_test = test<rtm::hazard_manager<foo>, ThreadType>;
+using bg_hazard_test = test<bg_hazard_type, ThreadType>;
+template <class ThreadType>
+using quiescent_test = test<rtm::quiescent_manager<foo>, ThreadType>;
+template <class ThreadType>
+using era_test = test<rtm::era_manager<foo>, ThreadType>;
+template <class ThreadType>
+using indexed_hazard_test = test<rtm::indexed_hazard_manager<foo>, ThreadType>;
 
 void reset_test()
 {
@@ -209,10 +265,53 @@ int main(int argn, char** argc)
     ttm::start_threads<counting_test>(p, it, n, counting_mngr);
     reset_test();
 
+    otm::out() << std::endl
+               << otm::color::bblue + "CACHED COUNTING RECLAMATION TEST"
+               << std::endl;
+    cached_counting_type cached_counting_mngr;
+    ttm::start_threads<cached_counting_test>(p, it, n, cached_counting_mngr);
+    reset_test();
+
     otm::out() << std::endl
                << otm::color::bblue + "HAZARD RECLAMATION TEST" << std::endl;
-    rtm::hazard_manager<foo> hazard_mngr;
+    hazard_type hazard_mngr;
     ttm::start_threads<hazard_test>(p, it, n, hazard_mngr);
     reset_test();
+
+    otm::out() << std::endl
+               << otm::color::bblue + "ASYMMETRIC HAZARD RECLAMATION TEST"
+               << std::endl;
+    asym_hazard_type asym_hazard_mngr;
+    ttm::start_threads<asym_hazard_test>(p, it, n, asym_hazard_mngr);
+    reset_test();
+
+    otm::out() << std::endl
+               << otm::color::bblue + "BACKGROUND HAZARD RECLAMATION TEST"
+               << std::endl;
+    rtm::background_reclaimer reclaimer;
+    bg_hazard_type bg_hazard_mngr{rtm::background_destructor<foo>(reclaimer)};
+    reclaimer.start(bg_hazard_mngr);
+    ttm::start_threads<bg_hazard_test>(p, it, n, bg_hazard_mngr);
+    reclaimer.stop();
+    reset_test();
+
+    otm::out() << std::endl
+               << otm::color::bblue + "INDEXED HAZARD RECLAMATION TEST"
+               << std::endl;
+    rtm::indexed_hazard_manager<foo> indexed_hazard_mngr;
+    ttm::start_threads<indexed_hazard_test>(p, it, n, indexed_hazard_mngr);
+    reset_test();
+
+    otm::out() << std::endl
+               << otm::color::bblue + "ERA RECLAMATION TEST" << std::endl;
+    rtm::era_manager<foo> era_mngr;
+    ttm::start_threads<era_test>(p, it, n, era_mngr);
+    reset_test();
+
+    otm::out() << std::endl
+               << otm::color::bblue + "QUIESCENT RECLAMATION TEST" << std::endl;
+    rtm::quiescent_manager<foo> quiescent_mngr;
+    ttm::start_threads<quiescent_test>(p, it, n, quiescent_mngr);
+    reset_test();
     return 0;
 }
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <atomic>
+#include <vector>
 
 #include "command_line_parser.hpp"
 #include "data_structures/concurrent_singly_linked_list.hpp"
@@ -12,47 +14,147 @@ namespace ttm = utils_tm::thread_tm;
 
 using queue_type =
     utm::concurrent_singly_linked_list<std::pair<size_t, size_t>>;
+using rec_mngr_type = typename queue_type::reclamation_manager_type;
+
 alignas(64) static queue_type queue;
+alignas(64) static rec_mngr_type rec_mngr;
 alignas(64) static std::atomic_size_t errors;
+alignas(64) static std::atomic_size_t popped;
+alignas(64) static std::atomic_size_t popped_sum;
+
+// each thread finds its own elements in decreasing order
+size_t check_order(size_t id, size_t n)
+{
+    size_t lerrors = 0;
+    int    prev    = n - 1;
+    for (auto it = queue.begin(); it != queue.end(); ++it)
+    {
+        auto [current, p] = *it;
+        if (p == id && int(current) != prev--)
+        {
+            lerrors++;
+            otm::out() << "Wrong order?" << std::endl;
+        }
+    }
+    if (prev != -1)
+    {
+        otm::out() << "Thread " << id << " not all elements found?"
+                   << std::endl;
+    }
+    return lerrors;
+}
 
 template <class ThreadType>
 struct test
 {
-    static int execute(ThreadType thrd, size_t n, size_t it)
+    static int
+    execute(ThreadType thrd, size_t n, size_t e, size_t b, size_t it)
     {
         utm::pin_to_core(thrd.id);
+        auto rec_handle = rec_mngr.get_handle();
+        e               = std::min(e, n);
 
         for (size_t i = 0; i < it; ++i)
         {
             if constexpr (thrd.is_main) { queue = queue_type(); }
 
             thrd.synchronized([&thrd, n]() {
-                size_t lerrors = 0;
-
                 for (size_t i = 0; i < n; ++i) { queue.emplace(i, thrd.id); }
-                int prev = n - 1;
-                for (auto it = queue.begin(); it != queue.end(); ++it)
+                errors.fetch_add(check_order(thrd.id, n),
+                                 std::memory_order_release);
+                return 0;
+            });
+
+            if (thrd.is_main && queue.size() != thrd.p * n)
+            {
+                thrd.out << "Unexpected Size " << queue.size() << "(expected "
+                         << thrd.p * n << ")" << std::endl;
+                errors.fetch_add(1);
+            }
+
+            // erase the e last pushed elements of each thread
+            thrd.synchronized([&thrd, &rec_handle, n, e]() {
+                size_t lerrors = 0;
+                for (size_t i = n - e; i < n; ++i)
                 {
-                    auto [current, p] = *it;
-                    if (p == thrd.id && int(current) != prev--)
+                    if (queue.erase(rec_handle, std::make_pair(i, thrd.id)) !=
+                        1)
                     {
                         lerrors++;
-                        otm::out() << "Wrong order?" << std::endl;
+                        otm::out() << "Element not erased?" << std::endl;
                     }
                 }
-                if (prev != -1)
+                if (queue.erase(rec_handle, std::make_pair(n, thrd.id)))
                 {
-                    otm::out() << "Thread " << thrd.id
-                               << " not all elements found?" << std::endl;
+                    lerrors++;
+                    otm::out() << "Erased nonexistent element?" << std::endl;
                 }
                 errors.fetch_add(lerrors, std::memory_order_release);
                 return 0;
             });
 
+            if (thrd.is_main && queue.size() != thrd.p * (n - e))
+            {
+                thrd.out << "Unexpected Size after erase " << queue.size()
+                         << "(expected " << thrd.p * (n - e) << ")"
+                         << std::endl;
+                errors.fetch_add(1);
+            }
+            if (thrd.is_main)
+            {
+                popped.store(0);
+                popped_sum.store(0);
+            }
+
+            // pop all remaining elements concurrently
+            thrd.synchronized([&rec_handle]() {
+                size_t lpopped = 0;
+                size_t lsum    = 0;
+                while (true)
+                {
+                    auto elem = queue.pop_front(rec_handle);
+                    if (!elem) break;
+                    lpopped++;
+                    lsum += elem.value().first;
+                }
+                popped.fetch_add(lpopped, std::memory_order_relaxed);
+                popped_sum.fetch_add(lsum, std::memory_order_relaxed);
+                return 0;
+            });
+
+            if (thrd.is_main &&
+                (popped.load() != thrd.p * (n - e) ||
+                 popped_sum.load() != thrd.p * ((n - e) * (n - e - 1) / 2) ||
+                 queue.size() != 0))
+            {
+                thrd.out << "Unexpected pop result " << popped.load()
+                         << " elements (expected " << thrd.p * (n - e) << ")"
+                         << std::endl;
+                errors.fetch_add(1);
+            }
+
+            // push all elements again in batches of b elements
+            thrd.synchronized([&thrd, n, b]() {
+                std::vector<std::pair<size_t, size_t>> batch;
+                batch.reserve(b);
+                for (size_t i = 0; i < n; i += b)
+                {
+                    batch.clear();
+                    for (size_t j = i; j < std::min(i + b, n); ++j)
+                    {
+                        batch.emplace_back(j, thrd.id);
+                    }
+                    queue.push(batch.begin(), batch.end());
+                }
+                errors.fetch_add(check_order(thrd.id, n),
+                                 std::memory_order_release);
+                return 0;
+            });
+
             if (thrd.is_main && queue.size() != thrd.p * n)
             {
-                thrd.out << "Unexpected Size " << queue.size() << "(expected "
-                         << thrd.p * n << ")" << std::endl;
+                thrd.out << "Unexpected Size after batch push " << queue.size()
+                         << "(expected " << thrd.p * n << ")" << std::endl;
                 errors.fetch_add(1);
             }
 
@@ -76,6 +178,8 @@ int main(int argn, char** argc)
 {
     utm::command_line_parser c{argn, argc};
     size_t                   n  = c.int_arg("-n", 1000000);
+    size_t                   e  = c.int_arg("-e", 100);
+    size_t                   b  = c.int_arg("-b", 1024);
     size_t                   p  = c.int_arg("-p", 4);
     size_t                   it = c.int_arg("-it", 8);
 
@@ -91,11 +195,15 @@ int main(int argn, char** argc)
                << otm::color::bblue << "  1. each thread pushes n elements"
                << std::endl
                << "  2. each thread iterates over elements and finds its own"
+               << std::endl
+               << "  3. each thread erases its e last elements" << std::endl
+               << "  4. all threads pop the remaining elements" << std::endl
+               << "  5. each thread pushes n elements in batches of b"
                << std::endl;
 
 
     otm::out() << otm::color::bgreen + "START TEST" << std::endl;
-    ttm::start_threads<test>(p, n, it);
+    ttm::start_threads<test>(p, n, e, b, it);
     otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
 
     return 0;
@@ -0,0 +1,152 @@
+#include <atomic>
+#include <string>
+
+#include "command_line_parser.hpp"
+#include "data_structures/split_ordered_hash_set.hpp"
+#include "output.hpp"
+#include "pin_thread.hpp"
+#include "thread_coordination.hpp"
+
+namespace utm = utils_tm;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+using set_type      = utm::split_ordered_hash_set<size_t>;
+using rec_mngr_type = typename set_type::reclamation_manager_type;
+
+alignas(64) static set_type*          set;
+alignas(64) static rec_mngr_type      rec_mngr;
+alignas(64) static std::atomic_size_t errors;
+
+std::string size_test(size_t exp, size_t real)
+{
+    if (exp == real) return "";
+    errors.fetch_add(1);
+    std::string str = "Unexpected Size! expected " + std::to_string(exp) +
+                      " found " + std::to_string(real) + "\n";
+    return str;
+}
+
+template <class ThreadType>
+struct test
+{
+    static int execute(ThreadType thrd, size_t n, size_t it)
+    {
+        utm::pin_to_core(thrd.id);
+        auto rec_handle = rec_mngr.get_handle();
+        auto p          = thrd.p;
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            if constexpr (thrd.is_main)
+            {
+                delete set;
+                set = new set_type(4);
+                errors.store(0);
+            }
+
+            // insert disjoint keys, every key is inserted twice
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (!set->insert(rec_handle, i * p + thrd.id)) ++lerrors;
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (set->insert(rec_handle, i * p + thrd.id)) ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            // the set might be deleted as soon as the main thread is done
+            if (thrd.is_main)
+            {
+                thrd.out << size_test(p * n, set->size())
+                         << (!errors.load() ? "Insert test successful!"
+                                            : "Insert test unsuccessful!")
+                         << " (capacity " << set->capacity() << ")"
+                         << std::endl;
+            }
+
+            // erase the even keys
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; i += 2)
+                {
+                    if (set->erase(rec_handle, i * p + thrd.id) != 1)
+                        ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            thrd.synchronized([&thrd, &rec_handle, n, p]() {
+                size_t lerrors = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (set->contains(rec_handle, i * p + thrd.id) != (i & 1))
+                        ++lerrors;
+                }
+                errors.fetch_add(lerrors, std::memory_order_release);
+                return 0;
+            });
+
+            if (thrd.is_main)
+            {
+                thrd.out << size_test(p * (n / 2), set->size())
+                         << (!errors.load() ? "Erase test successful!"
+                                            : "Erase test unsuccessful!")
+                         << std::endl;
+            }
+
+            if (!errors.load())
+            {
+                thrd.out << otm::color::green + "Test fully successful!"
+                         << std::endl;
+            }
+            else
+            {
+                thrd.out << otm::color::red + "Test unsuccessful!" << std::endl;
+            }
+        }
+
+        if constexpr (thrd.is_main)
+        {
+            delete set;
+            set = nullptr;
+        }
+        return 0;
+    }
+};
+
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c{argn, argc};
+    size_t                   n  = c.int_arg("-n", 100000);
+    size_t                   p  = c.int_arg("-p", 4);
+    size_t                   it = c.int_arg("-it", 8);
+
+    otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
+    otm::out() << "testing: split_ordered_hash_set" << std::endl;
+
+
+    otm::out() << "All threads insert disjoint keys into a small table,"
+               << std::endl
+               << "that has to grow concurrently. Then half of the keys are"
+               << std::endl
+               << "erased and all keys are looked up." << std::endl
+               << otm::color::bblue //
+               << "  1. each thread inserts n keys (twice)" << std::endl
+               << "  2. each thread erases its even keys" << std::endl
+               << "  3. each thread looks for all its keys" << std::endl;
+
+
+    otm::out() << otm::color::bgreen + "START TEST" << std::endl;
+    ttm::start_threads<test>(p, n, it);
+    otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
+
+    return 0;
+}
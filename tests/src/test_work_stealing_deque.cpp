@@ -0,0 +1,144 @@
+#include <atomic>
+#include <memory>
+
+#include "command_line_parser.hpp"
+#include "data_structures/work_stealing_deque.hpp"
+#include "output.hpp"
+#include "pin_thread.hpp"
+#include "thread_coordination.hpp"
+
+namespace utm = utils_tm;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+using deque_type = utm::work_stealing_deque<size_t>;
+
+alignas(64) static deque_type*                           deque;
+alignas(64) static std::unique_ptr<std::atomic_size_t[]> taken;
+alignas(64) static std::atomic_bool                      finished;
+alignas(64) static std::atomic_size_t                    errors;
+alignas(64) static std::atomic_size_t                    stolen;
+
+template <class ThreadType>
+struct test
+{
+    static int execute(ThreadType thrd, size_t n, size_t it)
+    {
+        utm::pin_to_core(thrd.id);
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            if constexpr (thrd.is_main)
+            {
+                delete deque;
+                deque = new deque_type(4); // forces the deque to grow
+                taken = std::make_unique<std::atomic_size_t[]>(n);
+                for (size_t j = 0; j < n; ++j) taken[j].store(0);
+                finished.store(false);
+                stolen.store(0);
+            }
+
+            // the owner pushes (popping every third element), all other
+            // threads steal until the owner has emptied the deque
+            thrd.synchronized([n]() {
+                if constexpr (ThreadType::is_main)
+                {
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        deque->push(j);
+                        if (j % 3 != 2) continue;
+                        auto elem = deque->pop();
+                        if (elem) taken[elem.value()].fetch_add(1);
+                    }
+                    while (true)
+                    {
+                        auto elem = deque->pop();
+                        if (!elem) break;
+                        taken[elem.value()].fetch_add(1);
+                    }
+                    finished.store(true);
+                }
+                else
+                {
+                    size_t lstolen = 0;
+                    while (!finished.load())
+                    {
+                        auto elem = deque->steal();
+                        if (!elem) continue;
+                        taken[elem.value()].fetch_add(1);
+                        ++lstolen;
+                    }
+                    stolen.fetch_add(lstolen);
+                }
+                return 0;
+            });
+
+            if constexpr (thrd.is_main)
+            {
+                size_t wrong = 0;
+                for (size_t j = 0; j < n; ++j)
+                    if (taken[j].load() != 1) ++wrong;
+                if (wrong || deque->size())
+                {
+                    thrd.out << otm::color::red << wrong
+                             << " elements were not taken exactly once"
+                             << otm::color::reset << std::endl;
+                    errors.fetch_add(1);
+                }
+                thrd.out << "stolen elements: " << stolen.load()
+                         << "   capacity: " << deque->capacity() << std::endl;
+
+                if (!errors.load())
+                {
+                    thrd.out << otm::color::green + "Test fully successful!"
+                             << std::endl;
+                }
+                else
+                {
+                    thrd.out << otm::color::red + "Test unsuccessful!"
+                             << std::endl;
+                }
+            }
+        }
+
+        if constexpr (thrd.is_main)
+        {
+            delete deque;
+            deque = nullptr;
+            taken.reset();
+        }
+        return 0;
+    }
+};
+
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c{argn, argc};
+    size_t                   n  = c.int_arg("-n", 1000000);
+    size_t                   p  = c.int_arg("-p", 4);
+    size_t                   it = c.int_arg("-it", 8);
+
+    otm::out() << otm::color::byellow + "START CORRECTNESS TEST" << std::endl;
+    otm::out() << "testing: work_stealing_deque" << std::endl;
+
+
+    otm::out() << "The main thread pushes and pops elements, while all other"
+               << std::endl
+               << "threads steal elements. Test weather each element was"
+               << std::endl
+               << "taken exactly once." << std::endl
+               << otm::color::bblue
+               << "  1. the owner pushes n elements (popping every third)"
+               << std::endl
+               << "  2. the owner pops the remaining elements" << std::endl
+               << "  3. other threads steal until the owner is finished"
+               << otm::color::reset << std::endl;
+
+
+    otm::out() << otm::color::bgreen + "START TEST" << std::endl;
+    ttm::start_threads<test>(p, n, it);
+    otm::out() << otm::color::bgreen + "END CORRECTNESS TEST" << std::endl;
+
+    return 0;
+}